@@ -241,10 +241,42 @@
     #undef MAX_SSID_IN_LIST
     #define MAX_SSID_IN_LIST      10
   #endif
+
+  // Start the Config Portal AP at once, and scan in the background, driven by run(). The SSID list is
+  // filled in the page when the scan is done, instead of delaying the AP by the 2-4s of a blocking scan
+  #if !defined(USING_ASYNC_WIFI_SCAN)
+    #define USING_ASYNC_WIFI_SCAN       false
+  #endif
+
+  // Keep the scan results (SSID, RSSI, channel, BSSID, auth mode) for SCAN_CACHE_TTL ms, and serve them as JSON.
+  // The page fetches its SSID list from there, and can rescan without reloading. Scans run in the background
+  #if !defined(USING_SCAN_CACHE)
+    #define USING_SCAN_CACHE            false
+  #endif
+
+  #if USING_SCAN_CACHE
+    #undef  USING_ASYNC_WIFI_SCAN
+    #define USING_ASYNC_WIFI_SCAN       true
+
+    #if !defined(SCAN_CACHE_TTL)
+      #define SCAN_CACHE_TTL            60000L
+    #endif
+
+    // Strongest results kept
+    #if !defined(SCAN_CACHE_MAX_SIZE)
+      #define SCAN_CACHE_MAX_SIZE       32
+    #endif
+  #endif
 #else
   #if (_ESP_WM_LITE_LOGLEVEL_ > 3)
     #warning SCAN_WIFI_NETWORKS disabled
   #endif
+
+  #undef  USING_ASYNC_WIFI_SCAN
+  #define USING_ASYNC_WIFI_SCAN         false
+
+  #undef  USING_SCAN_CACHE
+  #define USING_SCAN_CACHE              false
 #endif
 
 ///////// NEW for DRD /////////////
@@ -395,7 +427,14 @@ typedef struct
   char wifi_pw  [PASS_MAX_LEN];
 }  WiFi_Credentials;
 
-#define NUM_WIFI_CREDENTIALS      2
+// Sets of WiFi_Creds[], each with its SSID / PWD fields in the Config Portal. Changing it invalidates stored Config Data
+#if !defined(NUM_WIFI_CREDENTIALS)
+  #define NUM_WIFI_CREDENTIALS      2
+#elif (NUM_WIFI_CREDENTIALS < 1)
+  #error NUM_WIFI_CREDENTIALS must be at least 1
+#elif (NUM_WIFI_CREDENTIALS > 16)
+  #error NUM_WIFI_CREDENTIALS too high. Max 16
+#endif
 
 #if USING_BOARD_NAME
   // Configurable items besides fixed Header, just add board_name
@@ -418,7 +457,7 @@ typedef struct Configuration
   int  checkSum;
 } ESP_WM_LITE_Configuration;
 
-// Currently CONFIG_DATA_SIZE  =   236  = (16 + 96 * 2 + 4 + 24)
+// Currently CONFIG_DATA_SIZE  =   236  = (16 + 96 * NUM_WIFI_CREDENTIALS + 4 + 24)
 uint16_t CONFIG_DATA_SIZE = sizeof(ESP_WM_LITE_Configuration);
 
 ///////////////////////////////////////////
@@ -435,25 +474,21 @@ const char ESP_WM_LITE_HTML_HEAD_START[] PROGMEM = "<!DOCTYPE html><html><head><
 const char ESP_WM_LITE_HTML_HEAD_STYLE[] PROGMEM =
   "<style>div,input{padding:5px;font-size:1em;}input{width:95%;}body{text-align: center;}button{background-color:#16A1E7;color:#fff;line-height:2.4rem;font-size:1.2rem;width:100%;}fieldset{border-radius:0.3rem;margin:0px;}</style>";
 
+const char ESP_WM_LITE_HTML_HEAD_END[]   PROGMEM =
+  "</head><div style='text-align:left;display:inline-block;min-width:260px;'><fieldset>";
+
+// One per WiFi_Creds[]. {r} is '*' if required, {n} is "" for the 1st set, then "1", "2"...
+const char ESP_WM_LITE_HTML_CREDS[]     PROGMEM = "<div><label>{r}WiFi SSID{n}</label><div>[[input_id]]</div></div>\
+<div><label>{r}PWD{n} (8+ chars)</label><input value='[[pw{n}]]' id='pw{n}'><div></div></div>";
+
 #if USING_BOARD_NAME
-  const char ESP_WM_LITE_HTML_HEAD_END[]   PROGMEM =
-  "</head><div style='text-align:left;display:inline-block;min-width:260px;'>\
-  <fieldset><div><label>*WiFi SSID</label><div>[[input_id]]</div></div>\
-  <div><label>*PWD (8+ chars)</label><input value='[[pw]]' id='pw'><div></div></div>\
-  <div><label>*WiFi SSID1</label><div>[[input_id1]]</div></div>\
-  <div><label>*PWD1 (8+ chars)</label><input value='[[pw1]]' id='pw1'><div></div></div></fieldset>\
-  <fieldset><div><label>Board Name</label><input value='[[nm]]' id='nm'><div></div></div></fieldset>";  // DO NOT CHANGE THIS STRING EVER!!!!
+  const char ESP_WM_LITE_HTML_BOARD_NAME[] PROGMEM =
+  "</fieldset><fieldset><div><label>Board Name</label><input value='[[nm]]' id='nm'><div></div></div></fieldset>";
 #else
-  const char ESP_WM_LITE_HTML_HEAD_END[]   PROGMEM =
-  "</head><div style='text-align:left;display:inline-block;min-width:260px;'>\
-  <fieldset><div><label>*WiFi SSID</label><div>[[input_id]]</div></div>\
-  <div><label>*PWD (8+ chars)</label><input value='[[pw]]' id='pw'><div></div></div>\
-  <div><label>*WiFi SSID1</label><div>[[input_id1]]</div></div>\
-  <div><label>*PWD1 (8+ chars)</label><input value='[[pw1]]' id='pw1'><div></div></div></fieldset>";  // DO NOT CHANGE THIS STRING EVER!!!!
+  const char ESP_WM_LITE_HTML_BOARD_NAME[] PROGMEM = "</fieldset>";
 #endif
 
-const char ESP_WM_LITE_HTML_INPUT_ID[]   PROGMEM = "<input value='[[id]]' id='id'>";
-const char ESP_WM_LITE_HTML_INPUT_ID1[]  PROGMEM = "<input value='[[id1]]' id='id1'>";
+const char ESP_WM_LITE_HTML_INPUT_ID[]   PROGMEM = "<input value='[[id{n}]]' id='id{n}'>";
 
 const char ESP_WM_LITE_FLDSET_START[]  PROGMEM = "<fieldset>";
 const char ESP_WM_LITE_FLDSET_END[]    PROGMEM = "</fieldset>";
@@ -461,23 +496,15 @@ const char ESP_WM_LITE_HTML_PARAM[]    PROGMEM =
   "<div><label>{b}</label><input value='[[{v}]]'id='{i}'><div></div></div>";
 const char ESP_WM_LITE_HTML_BUTTON[]   PROGMEM = "<button onclick=\"sv()\">Save</button></div>";
 
-#if USING_BOARD_NAME
-  const char ESP_WM_LITE_HTML_SCRIPT[]   PROGMEM = "<script id=\"jsbin-javascript\">\
-  function udVal(key,val){var request=new XMLHttpRequest();var url='/?key='+key+'&value='+encodeURIComponent(val);\
-  request.open('GET',url,false);request.send(null);}\
-  function sv(){udVal('id',document.getElementById('id').value);udVal('pw',document.getElementById('pw').value);\
-  udVal('id1',document.getElementById('id1').value);udVal('pw1',document.getElementById('pw1').value);\
-  udVal('nm',document.getElementById('nm').value);";
-#else
-  const char ESP_WM_LITE_HTML_SCRIPT[]   PROGMEM = "<script id=\"jsbin-javascript\">\
-  function udVal(key,val){var request=new XMLHttpRequest();var url='/?key='+key+'&value='+encodeURIComponent(val);\
-  request.open('GET',url,false);request.send(null);}\
-  function sv(){udVal('id',document.getElementById('id').value);udVal('pw',document.getElementById('pw').value);\
-  udVal('id1',document.getElementById('id1').value);udVal('pw1',document.getElementById('pw1').value);";
-#endif
-
-const char ESP_WM_LITE_HTML_SCRIPT_ITEM[]  PROGMEM = "udVal('{d}',document.getElementById('{d}').value);";
-const char ESP_WM_LITE_HTML_SCRIPT_END[]   PROGMEM = "alert('Updated');}</script>";
+// All fields of the form are sent at once, in one POST to ESP_WM_LITE_SAVE_URL
+#define ESP_WM_LITE_SAVE_URL          "/save"
+
+const char ESP_WM_LITE_HTML_SCRIPT[]   PROGMEM = "<script id=\"jsbin-javascript\">\
+function sv(){var e=document.querySelectorAll('input[id],select[id]'),b=[];\
+for(var i=0;i<e.length;i++){b.push(encodeURIComponent(e[i].id)+'='+encodeURIComponent(e[i].value));}\
+var r=new XMLHttpRequest();r.open('POST','" ESP_WM_LITE_SAVE_URL "',true);\
+r.onload=function(){alert(r.status==200?'Updated':r.responseText);};r.onerror=function(){alert('Not sent');};\
+r.setRequestHeader('Content-Type','application/x-www-form-urlencoded');r.send(b.join('&'));}</script>";
 const char ESP_WM_LITE_HTML_END[]          PROGMEM = "</html>";
 
 #if SCAN_WIFI_NETWORKS
@@ -488,6 +515,678 @@ const char ESP_WM_LITE_HTML_END[]          PROGMEM = "</html>";
   const char ESP_WM_LITE_OPTION_START[]      PROGMEM = "<option>";
   const char ESP_WM_LITE_OPTION_END[]        PROGMEM = "";      // "</option>"; is not required
   const char ESP_WM_LITE_NO_NETWORKS_FOUND[] PROGMEM = "No suitable WiFi networks available!";
+
+  #if USING_ASYNC_WIFI_SCAN
+    #define ESP_WM_LITE_SCAN_URL            "/scan"
+
+    // Only in pages rendered while scanning : poll until the SSID list is ready, then fill it in
+    const char ESP_WM_LITE_SCANNING[]         PROGMEM = "Scanning...";
+    const char ESP_WM_LITE_HTML_SCAN_POLL[]   PROGMEM = "<script>function ps(){var r=new XMLHttpRequest();\
+r.onload=function(){if(r.status==202){setTimeout(ps,1000);return;}\
+var l=document.querySelectorAll('#SSIDs,select');for(var i=0;i<l.length;i++){l[i].innerHTML=r.responseText;}};\
+r.open('GET','" ESP_WM_LITE_SCAN_URL "',true);r.send();}ps();</script>";
+  #endif
+
+  #if USING_SCAN_CACHE
+    #define ESP_WM_LITE_SCAN_API_URL        "/api/scan"
+
+    // The SSID list is fetched from ESP_WM_LITE_SCAN_API_URL, polling while scanning. rs() starts a rescan
+    const char ESP_WM_LITE_HTML_RESCAN[]      PROGMEM = "<button type='button' onclick=\"rs()\">Rescan</button>";
+    const char ESP_WM_LITE_HTML_SCAN_LIST[]   PROGMEM = "<script>function ls(){var r=new XMLHttpRequest();\
+r.onload=function(){var j=JSON.parse(r.responseText),n=j.networks,t=[];if(j.scanning){setTimeout(ls,1000);t.push('Scanning...');}\
+else{for(var i=0;i<n.length;i++){t.push(n[i].ssid);}if(!t.length){t.push('No suitable WiFi networks available!');}}\
+var l=document.querySelectorAll('#SSIDs,select');for(var k=0;k<l.length;k++){l[k].innerHTML='';\
+for(var i=0;i<t.length;i++){var o=document.createElement('option');o.value=o.text=t[i];l[k].appendChild(o);}}};\
+r.open('GET','" ESP_WM_LITE_SCAN_API_URL "',true);r.send();}\
+function rs(){var r=new XMLHttpRequest();r.onload=ls;r.open('POST','" ESP_WM_LITE_SCAN_API_URL "',true);r.send();}ls();</script>";
+  #endif
+#endif
+
+//////////////////////////////////////////
+
+// Serve the default CSS and the JS from separate, cacheable endpoints, from gzipped PROGMEM blobs
+// generated by utils/gzip_assets.py. Only the dynamic form is then rendered per request
+#if !defined(USING_GZIPPED_ASSETS)
+  #define USING_GZIPPED_ASSETS        false
+#endif
+
+#if USING_GZIPPED_ASSETS
+  #include <ESPAsync_WiFiManager_Lite_Assets.h>
+
+  #define ESP_WM_LITE_CSS_URL         "/wm.css"
+  #define ESP_WM_LITE_JS_URL          "/wm.js"
+
+  // Version in URL, so that a new library version is never hidden by a cached old asset
+  const char ESP_WM_LITE_HTML_CSS_LINK[]  PROGMEM = "<link rel='stylesheet' href='" ESP_WM_LITE_CSS_URL "?v=" ESP_WM_LITE_CSS_VERSION "'>";
+  const char ESP_WM_LITE_HTML_JS_LINK[]   PROGMEM = "<script src='" ESP_WM_LITE_JS_URL "?v=" ESP_WM_LITE_JS_VERSION "'></script>";
+
+  // Strong ETags, so one per representation : plain, and gzipped
+  const char ESP_WM_LITE_CSS_ETAG[]       PROGMEM = "\"" ESP_WM_LITE_CSS_VERSION "\"";
+  const char ESP_WM_LITE_CSS_ETAG_GZ[]    PROGMEM = "\"" ESP_WM_LITE_CSS_VERSION "-gz\"";
+  const char ESP_WM_LITE_JS_ETAG[]        PROGMEM = "\"" ESP_WM_LITE_JS_VERSION "\"";
+  const char ESP_WM_LITE_JS_ETAG_GZ[]     PROGMEM = "\"" ESP_WM_LITE_JS_VERSION "-gz\"";
+#endif
+
+//////////////////////////////////////////
+
+// Answer the OS connectivity probes (Android, Apple, Windows, Firefox) and favicon requests with a tiny
+// redirect to the Config Portal, or a 204, instead of rendering the whole page for each of them
+#if !defined(USING_CAPTIVE_PROBE_ROUTES)
+  #define USING_CAPTIVE_PROBE_ROUTES  false
+#endif
+
+#if USING_CAPTIVE_PROBE_ROUTES
+
+typedef struct
+{
+  PGM_P     path;
+  uint16_t  code;         // 302 => redirect to the Config Portal page, else empty reply with this code
+} ESP_WM_LITE_Probe_Route;
+
+const char WM_PROBE_ANDROID[]       PROGMEM = "/generate_204";
+const char WM_PROBE_ANDROID_1[]     PROGMEM = "/gen_204";
+const char WM_PROBE_APPLE[]         PROGMEM = "/hotspot-detect.html";
+const char WM_PROBE_APPLE_1[]       PROGMEM = "/library/test/success.html";
+const char WM_PROBE_WINDOWS[]       PROGMEM = "/connecttest.txt";
+const char WM_PROBE_WINDOWS_1[]     PROGMEM = "/ncsi.txt";
+const char WM_PROBE_WINDOWS_2[]     PROGMEM = "/redirect";
+const char WM_PROBE_FIREFOX[]       PROGMEM = "/canonical.html";
+const char WM_PROBE_FIREFOX_1[]     PROGMEM = "/success.txt";
+const char WM_PROBE_FAVICON[]       PROGMEM = "/favicon.ico";
+
+const ESP_WM_LITE_Probe_Route ESP_WM_LITE_PROBE_ROUTES[] =
+{
+  { WM_PROBE_ANDROID,   302 },
+  { WM_PROBE_ANDROID_1, 302 },
+  { WM_PROBE_APPLE,     302 },
+  { WM_PROBE_APPLE_1,   302 },
+  { WM_PROBE_WINDOWS,   302 },
+  { WM_PROBE_WINDOWS_1, 302 },
+  { WM_PROBE_WINDOWS_2, 302 },
+  { WM_PROBE_FIREFOX,   302 },
+  { WM_PROBE_FIREFOX_1, 302 },
+  { WM_PROBE_FAVICON,   204 },
+};
+
+#define NUM_PROBE_ROUTES      ( sizeof(ESP_WM_LITE_PROBE_ROUTES) / sizeof(ESP_WM_LITE_Probe_Route) )
+
+#endif
+
+//////////////////////////////////////////
+
+// GET / PUT ESP_WM_LITE_CONFIG_API_URL : Config Data and dynamic parameters as compact JSON, for provisioning by scripts.
+// {"WiFi_Creds":[{"wifi_ssid":"","wifi_pw":""},...],"board_name":"","menu":{"<id>":"<value>",...}}
+#if !defined(USING_CONFIG_API)
+  #define USING_CONFIG_API            false
+#endif
+
+#if USING_CONFIG_API
+  #define ESP_WM_LITE_CONFIG_API_URL  "/api/config"
+
+  // WiFi_Creds (ssid, pw) and board_name
+  #define NUM_CONFIG_API_FIELDS       ( 2 * NUM_WIFI_CREDENTIALS + 1 )
+
+  // Larger PUT bodies are rejected
+  #if !defined(CONFIG_API_MAX_BODY_SIZE)
+    #define CONFIG_API_MAX_BODY_SIZE  2048
+  #endif
+#endif
+
+//////////////////////////////////////////
+
+// Precompiled Config Portal page. The HTML template is parsed once into literal spans,
+// each followed by an optional slot to be filled in with live data on every request
+const char ESP_WM_LITE_HTML_TITLE_SLOT[]  PROGMEM = "ESP_ASYNC_WM_LITE";
+const char ESP_WM_LITE_HTML_SLOT_START[]  PROGMEM = "[[";
+const char ESP_WM_LITE_HTML_SLOT_END[]    PROGMEM = "]]";
+
+#define WM_HTML_SLOT_NONE           (-1)
+#define WM_HTML_SLOT_TITLE          0
+#define WM_HTML_SLOT_NM             1
+// Slots of WiFi_Creds[i] are (WM_HTML_SLOT_CREDS + 2 * i) for the SSID, and the next for the PWD
+#define WM_HTML_SLOT_CREDS          2
+// Slot of myMenuItems[i] is (WM_HTML_SLOT_MENU_ITEM + i)
+#define WM_HTML_SLOT_MENU_ITEM      ( WM_HTML_SLOT_CREDS + 2 * NUM_WIFI_CREDENTIALS )
+
+typedef struct
+{
+  const char* text;       // NULL-terminated literal, pointing inside the parsed template buffer
+  uint16_t    length;     // strlen(text), to size the output buffer without rescanning
+  int16_t     slot;       // Slot to be filled after the literal, or WM_HTML_SLOT_NONE
+} ESP_WM_LITE_HTML_Span;
+
+#if SCAN_WIFI_NETWORKS
+// One WiFi scan result, read once from the WiFi driver, to be sorted and deduplicated
+typedef struct
+{
+  uint32_t  ssidHash;     // hashBytes() of the SSID
+  int16_t   index;        // Index in the WiFi scan results
+  int8_t    rssi;
+  uint8_t   channel;
+  uint8_t   bssid[6];
+} ESP_WM_LITE_Scan_Entry;
+
+#if USING_SCAN_CACHE
+// One cached WiFi scan result, kept after the WiFi driver's results are gone
+typedef struct
+{
+  char      ssid[33];     // Up to 32 chars
+  int8_t    rssi;
+  uint8_t   channel;
+  uint8_t   encryption;   // WiFi.encryptionType()
+  uint8_t   bssid[6];
+  bool      listed;       // Not a duplicate, and good enough to be offered in the Config Portal
+} ESP_WM_LITE_Scan_Result;
+#endif
+#endif
+
+// Stream the Config Portal page as a chunked response, instead of building it in one String
+#if !defined(USING_CHUNKED_RESPONSE)
+  #define USING_CHUNKED_RESPONSE      false
+#endif
+
+#if USING_CHUNKED_RESPONSE
+typedef struct
+{
+  uint16_t  part;         // Next part of the page, for createHTMLPart()
+  String    html;         // Current part, slots filled in
+  size_t    offset;       // Bytes of html already sent
+  bool      scanning;     // The page polls for the SSID list, as the scan was running when it was started
+} ESP_WM_LITE_HTML_Cursor;
+#endif
+
+// Keep the last rendered Config Portal page in RAM, with its content hash as ETag, to serve
+// repeated requests (several clients, OS captive-portal checkers) without rendering again
+#if !defined(USING_HTML_CACHE)
+  #define USING_HTML_CACHE            false
+#endif
+
+#if USING_HTML_CACHE
+  #if USING_CHUNKED_RESPONSE
+    #warning USING_HTML_CACHE not used with USING_CHUNKED_RESPONSE
+    #undef  USING_HTML_CACHE
+    #define USING_HTML_CACHE          false
+  #endif
+
+  // Larger pages are still rendered, and get an ETag, but are not kept
+  #if !defined(HTML_CACHE_MAX_SIZE)
+    #define HTML_CACHE_MAX_SIZE       4096
+  #endif
+#endif
+
+// Connect WiFi with a state machine advanced by run(), instead of blocking begin() and run() until connected or failed.
+// Each run() only polls WiFi.status(), and starts at most one association
+#if !defined(USING_NONBLOCKING_CONNECT)
+  #define USING_NONBLOCKING_CONNECT   false
+#endif
+
+#if USING_NONBLOCKING_CONNECT
+typedef enum
+{
+  WM_CONNECT_IDLE = 0,        // Not started, or stopped by the Config Portal
+  WM_CONNECT_CONNECTING,      // WiFi.begin() done with one set of credentials, waiting for association
+  WM_CONNECT_WAITING_IP,      // Associated, waiting for DHCP
+  WM_CONNECT_CONNECTED,
+  WM_CONNECT_BACKOFF,         // Waiting WIFI_RECON_INTERVAL, or the USING_RECONNECT_BACKOFF interval, before trying again
+  WM_CONNECT_SCANNING         // USING_SCAN_CONNECT : background scan for the strongest AP of the stored SSIDs
+} ESP_WM_LITE_Connect_State;
+#endif
+
+// Keep the STA link state from the WiFi events (got IP, disconnected with reason), instead of polling WiFi.status()
+// in each run(). Link loss is then seen at the next run(), not after up to 2 * WIFI_STATUS_CHECK_INTERVAL
+#if !defined(USING_WIFI_EVENTS)
+  #define USING_WIFI_EVENTS           false
+#endif
+
+#if USING_WIFI_EVENTS
+  // Written from the WiFi event task on ESP32
+  #include <atomic>
+
+  #if ESP32
+    #if ( defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 2) )
+      #define ESP_WM_LITE_EVENT_STA_GOT_IP          ARDUINO_EVENT_WIFI_STA_GOT_IP
+      #define ESP_WM_LITE_EVENT_STA_LOST_IP         ARDUINO_EVENT_WIFI_STA_LOST_IP
+      #define ESP_WM_LITE_EVENT_STA_DISCONNECTED    ARDUINO_EVENT_WIFI_STA_DISCONNECTED
+      #define ESP_WM_LITE_DISCONNECT_REASON(info)   (info).wifi_sta_disconnected.reason
+    #else
+      #define ESP_WM_LITE_EVENT_STA_GOT_IP          SYSTEM_EVENT_STA_GOT_IP
+      #define ESP_WM_LITE_EVENT_STA_LOST_IP         SYSTEM_EVENT_STA_LOST_IP
+      #define ESP_WM_LITE_EVENT_STA_DISCONNECTED    SYSTEM_EVENT_STA_DISCONNECTED
+      #define ESP_WM_LITE_DISCONNECT_REASON(info)   (info).disconnected.reason
+    #endif
+  #endif
+#endif
+
+// Remember the AP (BSSID, channel) of the last connection in RTC memory, and connect directly to it after a reset
+// or when WiFi is lost, without the all-channel scan of WiFiMulti. The usual connection is the fallback
+#if !defined(USING_FAST_CONNECT)
+  #define USING_FAST_CONNECT          false
+#endif
+
+// Reuse the DHCP lease got from the last connection's AP as static IP, when connecting directly to that AP again.
+// Our own IP is then probed by ARP in the background, and DHCP is used again if another host answers for it, or once
+// the lease has been used for DHCP_CACHE_MAX_TIME
+#if !defined(USING_DHCP_CACHE)
+  #define USING_DHCP_CACHE            false
+#endif
+
+#if USING_DHCP_CACHE
+  #if !USING_FAST_CONNECT
+    #undef  USING_FAST_CONNECT
+    #define USING_FAST_CONNECT        true
+  #endif
+
+  #if !defined(DHCP_CACHE_PROBE_TIMEOUT)
+    #define DHCP_CACHE_PROBE_TIMEOUT  2000L
+  #endif
+
+  // ARP request for our own IP repeated every
+  #define DHCP_CACHE_PROBE_INTERVAL   250L
+
+  // Connected time on the cached lease, counted from when DHCP gave it, before getting a new one by DHCP
+  #if !defined(DHCP_CACHE_MAX_TIME)
+    #define DHCP_CACHE_MAX_TIME       3600000L
+  #endif
+
+  // The time on the cached lease is recorded every
+  #define DHCP_CACHE_AGE_INTERVAL     60000L
+
+  #include <lwip/etharp.h>
+
+  #if ESP32
+    // lwIP is only to be called from its own thread
+    #include <lwip/tcpip.h>
+  #endif
+#endif
+
+#if USING_FAST_CONNECT
+  #if !defined(FAST_CONNECT_TIMEOUT)
+    #define FAST_CONNECT_TIMEOUT      5000L
+  #endif
+
+  #define FAST_CONNECT_MAGIC          0x46434F4EUL      // "FCON"
+
+typedef struct
+{
+  uint32_t  magic;        // FAST_CONNECT_MAGIC if valid
+  uint32_t  credsHash;    // hashBytes() of the SSID and PWD of WiFi_Creds[index]. Changed credentials aren't used
+  uint8_t   bssid[6];
+  uint8_t   channel;
+  uint8_t   index;        // In WiFi_Creds[]
+
+#if USING_DHCP_CACHE
+  uint32_t  ip;           // DHCP lease got on that AP, 0 if none
+  uint32_t  gateway;
+  uint32_t  subnet;
+  uint32_t  dns1;
+  uint32_t  dns2;
+  uint32_t  leaseAge;     // ms connected on that lease since DHCP gave it
+#endif
+
+  uint32_t  checksum;     // hashBytes() of all the above
+} ESP_WM_LITE_Fast_Connect;
+
+  #if ESP8266
+    // In 4-byte blocks of the RTC user memory (0-127). Keep clear of ESP_DoubleResetDetector's if ESP8266_DRD_USE_RTC
+    #if !defined(FAST_CONNECT_RTC_OFFSET)
+      #define FAST_CONNECT_RTC_OFFSET   32
+    #endif
+  #else
+    // Kept through resets and deep sleep, but not through power loss
+    RTC_NOINIT_ATTR ESP_WM_LITE_Fast_Connect ESP_WM_LITE_fastConnectRTC;
+  #endif
+#endif
+
+// Keep connection statistics of each WiFi_Creds[] in RAM, and try the credentials most likely to succeed first :
+// fewest failures in a row, then most recent success, then lowest average connect time
+#if !defined(USING_CREDS_RANKING)
+  #define USING_CREDS_RANKING         false
+#endif
+
+#if USING_CREDS_RANKING
+typedef struct
+{
+  uint32_t  lastSuccess;      // millis() of the last connection, 0 if never
+  uint32_t  avgLatency;       // ms from WiFi.begin() (or wifiMulti.run()) to connected, averaged over the last connections
+  uint16_t  successes;
+  uint16_t  failures;
+  uint8_t   failuresInRow;
+} ESP_WM_LITE_Creds_Stats;
+
+  // Number of last connections in avgLatency
+  #define CREDS_LATENCY_WEIGHT        8
+#endif
+
+// Scan once, and connect directly (WiFi.begin() to BSSID and channel) to the strongest AP of the stored SSIDs,
+// instead of letting wifiMulti.run() choose. The usual connection is the fallback
+#if !defined(USING_SCAN_CONNECT)
+  #define USING_SCAN_CONNECT          false
+#endif
+
+#if USING_SCAN_CONNECT
+  // dB another AP must be stronger than the AP of the last connection to be chosen instead
+  #if !defined(SCAN_CONNECT_HYSTERESIS)
+    #define SCAN_CONNECT_HYSTERESIS   5
+  #endif
+
+  // Max ms of the background scan of the non-blocking connection
+  #if !defined(SCAN_CONNECT_TIMEOUT)
+    #define SCAN_CONNECT_TIMEOUT      10000L
+  #endif
+#endif
+
+// Once connected, sample WiFi.RSSI() every ROAMING_SAMPLE_INTERVAL ms. When it stays under ROAMING_RSSI_THRESHOLD,
+// scan in the background, and move to an AP of the same SSID stronger by more than ROAMING_HYSTERESIS dB
+#if !defined(USING_ROAMING)
+  #define USING_ROAMING               false
+#endif
+
+#if USING_ROAMING
+  #if !defined(ROAMING_RSSI_THRESHOLD)
+    #define ROAMING_RSSI_THRESHOLD    -75
+  #endif
+
+  #if !defined(ROAMING_HYSTERESIS)
+    #define ROAMING_HYSTERESIS        8
+  #endif
+
+  #if !defined(ROAMING_SAMPLE_INTERVAL)
+    #define ROAMING_SAMPLE_INTERVAL   5000L
+  #endif
+
+  // Samples in a row under ROAMING_RSSI_THRESHOLD before scanning
+  #if !defined(ROAMING_LOW_SAMPLES)
+    #define ROAMING_LOW_SAMPLES       3
+  #endif
+
+  // Min ms between scans, and between moves to another AP
+  #if !defined(ROAMING_SCAN_INTERVAL)
+    #define ROAMING_SCAN_INTERVAL     60000L
+  #endif
+
+  #if !defined(ROAMING_MOVE_INTERVAL)
+    #define ROAMING_MOVE_INTERVAL     300000L
+  #endif
+
+  // Max ms of the background scan, and of the connection to the new AP. Reconnected as usual if it fails
+  #if !defined(ROAMING_TIMEOUT)
+    #define ROAMING_TIMEOUT           10000L
+  #endif
+#endif
+
+// Keep the WiFi connection while the Config Portal is up : the soft-AP runs with the STA (WIFI_AP_STA), on the STA
+// channel. A save is applied without reset (USING_HOT_APPLY). startConfigPortal() opens the portal at run time
+#if !defined(USING_AP_STA_PORTAL)
+  #define USING_AP_STA_PORTAL         false
+#endif
+
+// Apply a save from the Config Portal without reset : the portal is closed, WiFi reconnected only if the credentials
+// changed, and the callback set by setMenuItemChangeCallback() called for each changed MenuItem. Reset only if a
+// MenuItem changed without callback, or if the callback asks for it
+#if !defined(USING_HOT_APPLY)
+  #define USING_HOT_APPLY             false
+#endif
+
+#if (USING_AP_STA_PORTAL && !USING_HOT_APPLY)
+  #undef  USING_HOT_APPLY
+  #define USING_HOT_APPLY             true
+#endif
+
+#if USING_HOT_APPLY
+  // ms between a save and its apply, which closes the Config Portal, for the reply to the save to be sent
+  #if !defined(HOT_APPLY_DELAY)
+    #define HOT_APPLY_DELAY           1000L
+  #endif
+
+  // To recreate wifiMulti in place with the new credentials
+  #include <new>
+
+// Called with the index in myMenuItems[] of a changed MenuItem. Returns true if a reset is needed to use it
+typedef bool (*ESP_WM_LITE_Change_Callback)(const uint16_t& index);
+#endif
+
+// Compare the stored Config Data, dynamic data and CP flag with the ones in RAM before writing them to EEPROM,
+// LittleFS or SPIFFS, and skip the write if unchanged. Saves a flash write at each boot with LOAD_DEFAULT_CONFIG_DATA
+#if !defined(USING_WRITE_AVOIDANCE)
+  #define USING_WRITE_AVOIDANCE       false
+#endif
+
+// CRC32 instead of the byte-sum checksum for the stored Config Data and dynamic data. Data stored with the byte-sum
+// by previous versions stays valid, and is written with CRC32 by the next save. Set false to keep writing the byte-sum.
+// Slower than the byte-sum on ESP8266, see README
+#if !defined(USING_CRC32_CHECKSUM)
+  #define USING_CRC32_CHECKSUM        true
+#endif
+
+#ifdef ESP8266
+  // CRC-32 (IEEE 802.3, reflected 0xEDB88320), slice-by-4 : ESP_WM_LITE_CRC32_TABLE[0] is the usual byte table,
+  // [k] the CRC of a byte followed by k zero bytes, to process 4 bytes with 4 independent lookups. 4KB of flash
+  const uint32_t ESP_WM_LITE_CRC32_TABLE[4][256] PROGMEM =
+  {
+    {
+      0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
+      0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
+      0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2,
+      0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+      0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9,
+      0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172,
+      0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
+      0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+      0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423,
+      0xCFBA9599, 0xB8BDA50F, 0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924,
+      0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D, 0x76DC4190, 0x01DB7106,
+      0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+      0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D,
+      0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
+      0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950,
+      0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+      0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7,
+      0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0,
+      0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9, 0x5005713C, 0x270241AA,
+      0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+      0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
+      0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A,
+      0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84,
+      0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+      0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB,
+      0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC,
+      0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8, 0xA1D1937E,
+      0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+      0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55,
+      0x316E8EEF, 0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236,
+      0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28,
+      0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+      0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F,
+      0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38,
+      0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
+      0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+      0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69,
+      0x616BFFD3, 0x166CCF45, 0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2,
+      0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC,
+      0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+      0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693,
+      0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
+      0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+    },
+    {
+      0x00000000, 0x191B3141, 0x32366282, 0x2B2D53C3, 0x646CC504, 0x7D77F445,
+      0x565AA786, 0x4F4196C7, 0xC8D98A08, 0xD1C2BB49, 0xFAEFE88A, 0xE3F4D9CB,
+      0xACB54F0C, 0xB5AE7E4D, 0x9E832D8E, 0x87981CCF, 0x4AC21251, 0x53D92310,
+      0x78F470D3, 0x61EF4192, 0x2EAED755, 0x37B5E614, 0x1C98B5D7, 0x05838496,
+      0x821B9859, 0x9B00A918, 0xB02DFADB, 0xA936CB9A, 0xE6775D5D, 0xFF6C6C1C,
+      0xD4413FDF, 0xCD5A0E9E, 0x958424A2, 0x8C9F15E3, 0xA7B24620, 0xBEA97761,
+      0xF1E8E1A6, 0xE8F3D0E7, 0xC3DE8324, 0xDAC5B265, 0x5D5DAEAA, 0x44469FEB,
+      0x6F6BCC28, 0x7670FD69, 0x39316BAE, 0x202A5AEF, 0x0B07092C, 0x121C386D,
+      0xDF4636F3, 0xC65D07B2, 0xED705471, 0xF46B6530, 0xBB2AF3F7, 0xA231C2B6,
+      0x891C9175, 0x9007A034, 0x179FBCFB, 0x0E848DBA, 0x25A9DE79, 0x3CB2EF38,
+      0x73F379FF, 0x6AE848BE, 0x41C51B7D, 0x58DE2A3C, 0xF0794F05, 0xE9627E44,
+      0xC24F2D87, 0xDB541CC6, 0x94158A01, 0x8D0EBB40, 0xA623E883, 0xBF38D9C2,
+      0x38A0C50D, 0x21BBF44C, 0x0A96A78F, 0x138D96CE, 0x5CCC0009, 0x45D73148,
+      0x6EFA628B, 0x77E153CA, 0xBABB5D54, 0xA3A06C15, 0x888D3FD6, 0x91960E97,
+      0xDED79850, 0xC7CCA911, 0xECE1FAD2, 0xF5FACB93, 0x7262D75C, 0x6B79E61D,
+      0x4054B5DE, 0x594F849F, 0x160E1258, 0x0F152319, 0x243870DA, 0x3D23419B,
+      0x65FD6BA7, 0x7CE65AE6, 0x57CB0925, 0x4ED03864, 0x0191AEA3, 0x188A9FE2,
+      0x33A7CC21, 0x2ABCFD60, 0xAD24E1AF, 0xB43FD0EE, 0x9F12832D, 0x8609B26C,
+      0xC94824AB, 0xD05315EA, 0xFB7E4629, 0xE2657768, 0x2F3F79F6, 0x362448B7,
+      0x1D091B74, 0x04122A35, 0x4B53BCF2, 0x52488DB3, 0x7965DE70, 0x607EEF31,
+      0xE7E6F3FE, 0xFEFDC2BF, 0xD5D0917C, 0xCCCBA03D, 0x838A36FA, 0x9A9107BB,
+      0xB1BC5478, 0xA8A76539, 0x3B83984B, 0x2298A90A, 0x09B5FAC9, 0x10AECB88,
+      0x5FEF5D4F, 0x46F46C0E, 0x6DD93FCD, 0x74C20E8C, 0xF35A1243, 0xEA412302,
+      0xC16C70C1, 0xD8774180, 0x9736D747, 0x8E2DE606, 0xA500B5C5, 0xBC1B8484,
+      0x71418A1A, 0x685ABB5B, 0x4377E898, 0x5A6CD9D9, 0x152D4F1E, 0x0C367E5F,
+      0x271B2D9C, 0x3E001CDD, 0xB9980012, 0xA0833153, 0x8BAE6290, 0x92B553D1,
+      0xDDF4C516, 0xC4EFF457, 0xEFC2A794, 0xF6D996D5, 0xAE07BCE9, 0xB71C8DA8,
+      0x9C31DE6B, 0x852AEF2A, 0xCA6B79ED, 0xD37048AC, 0xF85D1B6F, 0xE1462A2E,
+      0x66DE36E1, 0x7FC507A0, 0x54E85463, 0x4DF36522, 0x02B2F3E5, 0x1BA9C2A4,
+      0x30849167, 0x299FA026, 0xE4C5AEB8, 0xFDDE9FF9, 0xD6F3CC3A, 0xCFE8FD7B,
+      0x80A96BBC, 0x99B25AFD, 0xB29F093E, 0xAB84387F, 0x2C1C24B0, 0x350715F1,
+      0x1E2A4632, 0x07317773, 0x4870E1B4, 0x516BD0F5, 0x7A468336, 0x635DB277,
+      0xCBFAD74E, 0xD2E1E60F, 0xF9CCB5CC, 0xE0D7848D, 0xAF96124A, 0xB68D230B,
+      0x9DA070C8, 0x84BB4189, 0x03235D46, 0x1A386C07, 0x31153FC4, 0x280E0E85,
+      0x674F9842, 0x7E54A903, 0x5579FAC0, 0x4C62CB81, 0x8138C51F, 0x9823F45E,
+      0xB30EA79D, 0xAA1596DC, 0xE554001B, 0xFC4F315A, 0xD7626299, 0xCE7953D8,
+      0x49E14F17, 0x50FA7E56, 0x7BD72D95, 0x62CC1CD4, 0x2D8D8A13, 0x3496BB52,
+      0x1FBBE891, 0x06A0D9D0, 0x5E7EF3EC, 0x4765C2AD, 0x6C48916E, 0x7553A02F,
+      0x3A1236E8, 0x230907A9, 0x0824546A, 0x113F652B, 0x96A779E4, 0x8FBC48A5,
+      0xA4911B66, 0xBD8A2A27, 0xF2CBBCE0, 0xEBD08DA1, 0xC0FDDE62, 0xD9E6EF23,
+      0x14BCE1BD, 0x0DA7D0FC, 0x268A833F, 0x3F91B27E, 0x70D024B9, 0x69CB15F8,
+      0x42E6463B, 0x5BFD777A, 0xDC656BB5, 0xC57E5AF4, 0xEE530937, 0xF7483876,
+      0xB809AEB1, 0xA1129FF0, 0x8A3FCC33, 0x9324FD72
+    },
+    {
+      0x00000000, 0x01C26A37, 0x0384D46E, 0x0246BE59, 0x0709A8DC, 0x06CBC2EB,
+      0x048D7CB2, 0x054F1685, 0x0E1351B8, 0x0FD13B8F, 0x0D9785D6, 0x0C55EFE1,
+      0x091AF964, 0x08D89353, 0x0A9E2D0A, 0x0B5C473D, 0x1C26A370, 0x1DE4C947,
+      0x1FA2771E, 0x1E601D29, 0x1B2F0BAC, 0x1AED619B, 0x18ABDFC2, 0x1969B5F5,
+      0x1235F2C8, 0x13F798FF, 0x11B126A6, 0x10734C91, 0x153C5A14, 0x14FE3023,
+      0x16B88E7A, 0x177AE44D, 0x384D46E0, 0x398F2CD7, 0x3BC9928E, 0x3A0BF8B9,
+      0x3F44EE3C, 0x3E86840B, 0x3CC03A52, 0x3D025065, 0x365E1758, 0x379C7D6F,
+      0x35DAC336, 0x3418A901, 0x3157BF84, 0x3095D5B3, 0x32D36BEA, 0x331101DD,
+      0x246BE590, 0x25A98FA7, 0x27EF31FE, 0x262D5BC9, 0x23624D4C, 0x22A0277B,
+      0x20E69922, 0x2124F315, 0x2A78B428, 0x2BBADE1F, 0x29FC6046, 0x283E0A71,
+      0x2D711CF4, 0x2CB376C3, 0x2EF5C89A, 0x2F37A2AD, 0x709A8DC0, 0x7158E7F7,
+      0x731E59AE, 0x72DC3399, 0x7793251C, 0x76514F2B, 0x7417F172, 0x75D59B45,
+      0x7E89DC78, 0x7F4BB64F, 0x7D0D0816, 0x7CCF6221, 0x798074A4, 0x78421E93,
+      0x7A04A0CA, 0x7BC6CAFD, 0x6CBC2EB0, 0x6D7E4487, 0x6F38FADE, 0x6EFA90E9,
+      0x6BB5866C, 0x6A77EC5B, 0x68315202, 0x69F33835, 0x62AF7F08, 0x636D153F,
+      0x612BAB66, 0x60E9C151, 0x65A6D7D4, 0x6464BDE3, 0x662203BA, 0x67E0698D,
+      0x48D7CB20, 0x4915A117, 0x4B531F4E, 0x4A917579, 0x4FDE63FC, 0x4E1C09CB,
+      0x4C5AB792, 0x4D98DDA5, 0x46C49A98, 0x4706F0AF, 0x45404EF6, 0x448224C1,
+      0x41CD3244, 0x400F5873, 0x4249E62A, 0x438B8C1D, 0x54F16850, 0x55330267,
+      0x5775BC3E, 0x56B7D609, 0x53F8C08C, 0x523AAABB, 0x507C14E2, 0x51BE7ED5,
+      0x5AE239E8, 0x5B2053DF, 0x5966ED86, 0x58A487B1, 0x5DEB9134, 0x5C29FB03,
+      0x5E6F455A, 0x5FAD2F6D, 0xE1351B80, 0xE0F771B7, 0xE2B1CFEE, 0xE373A5D9,
+      0xE63CB35C, 0xE7FED96B, 0xE5B86732, 0xE47A0D05, 0xEF264A38, 0xEEE4200F,
+      0xECA29E56, 0xED60F461, 0xE82FE2E4, 0xE9ED88D3, 0xEBAB368A, 0xEA695CBD,
+      0xFD13B8F0, 0xFCD1D2C7, 0xFE976C9E, 0xFF5506A9, 0xFA1A102C, 0xFBD87A1B,
+      0xF99EC442, 0xF85CAE75, 0xF300E948, 0xF2C2837F, 0xF0843D26, 0xF1465711,
+      0xF4094194, 0xF5CB2BA3, 0xF78D95FA, 0xF64FFFCD, 0xD9785D60, 0xD8BA3757,
+      0xDAFC890E, 0xDB3EE339, 0xDE71F5BC, 0xDFB39F8B, 0xDDF521D2, 0xDC374BE5,
+      0xD76B0CD8, 0xD6A966EF, 0xD4EFD8B6, 0xD52DB281, 0xD062A404, 0xD1A0CE33,
+      0xD3E6706A, 0xD2241A5D, 0xC55EFE10, 0xC49C9427, 0xC6DA2A7E, 0xC7184049,
+      0xC25756CC, 0xC3953CFB, 0xC1D382A2, 0xC011E895, 0xCB4DAFA8, 0xCA8FC59F,
+      0xC8C97BC6, 0xC90B11F1, 0xCC440774, 0xCD866D43, 0xCFC0D31A, 0xCE02B92D,
+      0x91AF9640, 0x906DFC77, 0x922B422E, 0x93E92819, 0x96A63E9C, 0x976454AB,
+      0x9522EAF2, 0x94E080C5, 0x9FBCC7F8, 0x9E7EADCF, 0x9C381396, 0x9DFA79A1,
+      0x98B56F24, 0x99770513, 0x9B31BB4A, 0x9AF3D17D, 0x8D893530, 0x8C4B5F07,
+      0x8E0DE15E, 0x8FCF8B69, 0x8A809DEC, 0x8B42F7DB, 0x89044982, 0x88C623B5,
+      0x839A6488, 0x82580EBF, 0x801EB0E6, 0x81DCDAD1, 0x8493CC54, 0x8551A663,
+      0x8717183A, 0x86D5720D, 0xA9E2D0A0, 0xA820BA97, 0xAA6604CE, 0xABA46EF9,
+      0xAEEB787C, 0xAF29124B, 0xAD6FAC12, 0xACADC625, 0xA7F18118, 0xA633EB2F,
+      0xA4755576, 0xA5B73F41, 0xA0F829C4, 0xA13A43F3, 0xA37CFDAA, 0xA2BE979D,
+      0xB5C473D0, 0xB40619E7, 0xB640A7BE, 0xB782CD89, 0xB2CDDB0C, 0xB30FB13B,
+      0xB1490F62, 0xB08B6555, 0xBBD72268, 0xBA15485F, 0xB853F606, 0xB9919C31,
+      0xBCDE8AB4, 0xBD1CE083, 0xBF5A5EDA, 0xBE9834ED
+    },
+    {
+      0x00000000, 0xB8BC6765, 0xAA09C88B, 0x12B5AFEE, 0x8F629757, 0x37DEF032,
+      0x256B5FDC, 0x9DD738B9, 0xC5B428EF, 0x7D084F8A, 0x6FBDE064, 0xD7018701,
+      0x4AD6BFB8, 0xF26AD8DD, 0xE0DF7733, 0x58631056, 0x5019579F, 0xE8A530FA,
+      0xFA109F14, 0x42ACF871, 0xDF7BC0C8, 0x67C7A7AD, 0x75720843, 0xCDCE6F26,
+      0x95AD7F70, 0x2D111815, 0x3FA4B7FB, 0x8718D09E, 0x1ACFE827, 0xA2738F42,
+      0xB0C620AC, 0x087A47C9, 0xA032AF3E, 0x188EC85B, 0x0A3B67B5, 0xB28700D0,
+      0x2F503869, 0x97EC5F0C, 0x8559F0E2, 0x3DE59787, 0x658687D1, 0xDD3AE0B4,
+      0xCF8F4F5A, 0x7733283F, 0xEAE41086, 0x525877E3, 0x40EDD80D, 0xF851BF68,
+      0xF02BF8A1, 0x48979FC4, 0x5A22302A, 0xE29E574F, 0x7F496FF6, 0xC7F50893,
+      0xD540A77D, 0x6DFCC018, 0x359FD04E, 0x8D23B72B, 0x9F9618C5, 0x272A7FA0,
+      0xBAFD4719, 0x0241207C, 0x10F48F92, 0xA848E8F7, 0x9B14583D, 0x23A83F58,
+      0x311D90B6, 0x89A1F7D3, 0x1476CF6A, 0xACCAA80F, 0xBE7F07E1, 0x06C36084,
+      0x5EA070D2, 0xE61C17B7, 0xF4A9B859, 0x4C15DF3C, 0xD1C2E785, 0x697E80E0,
+      0x7BCB2F0E, 0xC377486B, 0xCB0D0FA2, 0x73B168C7, 0x6104C729, 0xD9B8A04C,
+      0x446F98F5, 0xFCD3FF90, 0xEE66507E, 0x56DA371B, 0x0EB9274D, 0xB6054028,
+      0xA4B0EFC6, 0x1C0C88A3, 0x81DBB01A, 0x3967D77F, 0x2BD27891, 0x936E1FF4,
+      0x3B26F703, 0x839A9066, 0x912F3F88, 0x299358ED, 0xB4446054, 0x0CF80731,
+      0x1E4DA8DF, 0xA6F1CFBA, 0xFE92DFEC, 0x462EB889, 0x549B1767, 0xEC277002,
+      0x71F048BB, 0xC94C2FDE, 0xDBF98030, 0x6345E755, 0x6B3FA09C, 0xD383C7F9,
+      0xC1366817, 0x798A0F72, 0xE45D37CB, 0x5CE150AE, 0x4E54FF40, 0xF6E89825,
+      0xAE8B8873, 0x1637EF16, 0x048240F8, 0xBC3E279D, 0x21E91F24, 0x99557841,
+      0x8BE0D7AF, 0x335CB0CA, 0xED59B63B, 0x55E5D15E, 0x47507EB0, 0xFFEC19D5,
+      0x623B216C, 0xDA874609, 0xC832E9E7, 0x708E8E82, 0x28ED9ED4, 0x9051F9B1,
+      0x82E4565F, 0x3A58313A, 0xA78F0983, 0x1F336EE6, 0x0D86C108, 0xB53AA66D,
+      0xBD40E1A4, 0x05FC86C1, 0x1749292F, 0xAFF54E4A, 0x322276F3, 0x8A9E1196,
+      0x982BBE78, 0x2097D91D, 0x78F4C94B, 0xC048AE2E, 0xD2FD01C0, 0x6A4166A5,
+      0xF7965E1C, 0x4F2A3979, 0x5D9F9697, 0xE523F1F2, 0x4D6B1905, 0xF5D77E60,
+      0xE762D18E, 0x5FDEB6EB, 0xC2098E52, 0x7AB5E937, 0x680046D9, 0xD0BC21BC,
+      0x88DF31EA, 0x3063568F, 0x22D6F961, 0x9A6A9E04, 0x07BDA6BD, 0xBF01C1D8,
+      0xADB46E36, 0x15080953, 0x1D724E9A, 0xA5CE29FF, 0xB77B8611, 0x0FC7E174,
+      0x9210D9CD, 0x2AACBEA8, 0x38191146, 0x80A57623, 0xD8C66675, 0x607A0110,
+      0x72CFAEFE, 0xCA73C99B, 0x57A4F122, 0xEF189647, 0xFDAD39A9, 0x45115ECC,
+      0x764DEE06, 0xCEF18963, 0xDC44268D, 0x64F841E8, 0xF92F7951, 0x41931E34,
+      0x5326B1DA, 0xEB9AD6BF, 0xB3F9C6E9, 0x0B45A18C, 0x19F00E62, 0xA14C6907,
+      0x3C9B51BE, 0x842736DB, 0x96929935, 0x2E2EFE50, 0x2654B999, 0x9EE8DEFC,
+      0x8C5D7112, 0x34E11677, 0xA9362ECE, 0x118A49AB, 0x033FE645, 0xBB838120,
+      0xE3E09176, 0x5B5CF613, 0x49E959FD, 0xF1553E98, 0x6C820621, 0xD43E6144,
+      0xC68BCEAA, 0x7E37A9CF, 0xD67F4138, 0x6EC3265D, 0x7C7689B3, 0xC4CAEED6,
+      0x591DD66F, 0xE1A1B10A, 0xF3141EE4, 0x4BA87981, 0x13CB69D7, 0xAB770EB2,
+      0xB9C2A15C, 0x017EC639, 0x9CA9FE80, 0x241599E5, 0x36A0360B, 0x8E1C516E,
+      0x866616A7, 0x3EDA71C2, 0x2C6FDE2C, 0x94D3B949, 0x090481F0, 0xB1B8E695,
+      0xA30D497B, 0x1BB12E1E, 0x43D23E48, 0xFB6E592D, 0xE9DBF6C3, 0x516791A6,
+      0xCCB0A91F, 0x740CCE7A, 0x66B96194, 0xDE0506F1
+    }
+  };
+#elif ( defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 2) )
+  // Same CRC-32, in ROM
+  #include <esp_rom_crc.h>
+  #define ESP_WM_LITE_ROM_CRC32_LE(crc, buf, len)     esp_rom_crc32_le(crc, buf, len)
+#else
+  #include <rom/crc.h>
+  #define ESP_WM_LITE_ROM_CRC32_LE(crc, buf, len)     crc32_le(crc, buf, len)
+#endif
+
+// LittleFS/SPIFFS : store the Config Data, the forced CP flag and the dynamic data in one record, with a sequence
+// number and a CRC32, written alternately to 2 files (slots). A save is one file write, and a power loss during it
+// leaves the previous record valid in the other slot. Data in the files of previous versions is loaded if no record
+#if !defined(USING_AB_RECORD_STORAGE)
+  #define USING_AB_RECORD_STORAGE     false
+#endif
+
+#if ( USING_AB_RECORD_STORAGE && !( USE_LITTLEFS || USE_SPIFFS ) )
+  #warning USING_AB_RECORD_STORAGE only for LittleFS or SPIFFS. Not used with EEPROM
+  #undef  USING_AB_RECORD_STORAGE
+  #define USING_AB_RECORD_STORAGE     false
+#endif
+
+#if USING_AB_RECORD_STORAGE
+  #define ESP_WM_LITE_RECORD_MAGIC    0x524C4D57      // "WMLR"
+
+// Followed by the payload : ESP_WM_LITE_config, the forced CP flag, then the dynamic data as in CREDENTIALS_FILENAME
+typedef struct
+{
+  uint32_t  magic;
+  uint32_t  sequence;     // Incremented by each save. The valid slot with the highest one is used
+  uint32_t  length;       // Of the payload
+  uint32_t  crc;          // calcCRC32() of magic, sequence, length and the payload
+} ESP_WM_LITE_Record_Header;
+#endif
+
+#if (USING_SCAN_CONNECT || USING_ROAMING)
+typedef struct
+{
+  uint8_t   index;        // WiFi_Creds[] with its SSID
+  uint8_t   bssid[6];
+  uint8_t   channel;
+  int32_t   rssi;
+} ESP_WM_LITE_AP_Candidate;
 #endif
 
 //////////////////////////////////////////
@@ -506,6 +1205,17 @@ const char WM_HTTP_EXPIRES[]         PROGMEM = "Expires";
 const char WM_HTTP_CORS[]            PROGMEM = "Access-Control-Allow-Origin";
 const char WM_HTTP_CORS_ALLOW_ALL[]  PROGMEM = "*";
 
+const char WM_HTTP_HEAD_TEXT_CSS[]   PROGMEM = "text/css";
+const char WM_HTTP_HEAD_TEXT_JS[]    PROGMEM = "application/javascript";
+const char WM_HTTP_HEAD_JSON[]       PROGMEM = "application/json";
+const char WM_HTTP_ACCEPT_ENCODING[] PROGMEM = "Accept-Encoding";
+const char WM_HTTP_CONTENT_ENCODING[] PROGMEM = "Content-Encoding";
+const char WM_HTTP_GZIP[]            PROGMEM = "gzip";
+const char WM_HTTP_VARY[]            PROGMEM = "Vary";
+const char WM_HTTP_ETAG[]            PROGMEM = "ETag";
+const char WM_HTTP_IF_NONE_MATCH[]   PROGMEM = "If-None-Match";
+const char WM_HTTP_CACHE_LONG[]      PROGMEM = "public, max-age=31536000";
+
 //////////////////////////////////////////
 
 #if (ESP32)
@@ -554,13 +1264,50 @@ String IPAddressToString(const IPAddress& _address)
 
 //////////////////////////////////////////
 
+// Config Portal data (SSID list, parsed page template, scan results) is shared by run() and the web server's
+// callbacks. On ESP32, these run on different tasks (loop and async_tcp), so both hold the portal lock around it.
+// On ESP8266, callbacks run from the loop too, and there is nothing to lock
+#if ESP32
+
+class ESP_WM_LITE_Lock
+{
+  public:
+
+    explicit ESP_WM_LITE_Lock(SemaphoreHandle_t mutex) : _mutex(mutex)
+    {
+      if (_mutex)
+        xSemaphoreTakeRecursive(_mutex, portMAX_DELAY);
+    }
+
+    ~ESP_WM_LITE_Lock()
+    {
+      if (_mutex)
+        xSemaphoreGiveRecursive(_mutex);
+    }
+
+  private:
+
+    SemaphoreHandle_t _mutex;
+};
+
+  // Held until the end of the enclosing block. Recursive, as locked functions call each other
+  #define ESP_WM_LITE_LOCK_PORTAL()     ESP_WM_LITE_Lock portalLock(_portalMutex)
+
+#else
+  #define ESP_WM_LITE_LOCK_PORTAL()
+#endif
+
+//////////////////////////////////////////
+
 class ESPAsync_WiFiManager_Lite
 {
   public:
 
     ESPAsync_WiFiManager_Lite()
     {
-
+#if ESP32
+      _portalMutex = xSemaphoreCreateRecursiveMutex();
+#endif
     }
 
     //////////////////////////////////////////
@@ -585,10 +1332,27 @@ class ESPAsync_WiFiManager_Lite
 
 #endif
       }
+
+      clearHTMLSlots();
+
+#if USING_SCAN_CACHE
+      free(_scanCache);
+#endif
+
+#if (USING_HOT_APPLY && USE_DYNAMIC_PARAMETERS)
+      free(_stagedMenuData);
+#endif
+
+#if ESP32
+      if (_portalMutex)
+        vSemaphoreDelete(_portalMutex);
+#endif
     }
 
     //////////////////////////////////////////
 
+#define TIMEOUT_CONNECT_WIFI      30000
+
     void connectWiFi(const char* ssid, const char* pass)
     {
       ESP_WML_LOGINFO1(F("Con2:"), ssid);
@@ -629,7 +1393,30 @@ class ESPAsync_WiFiManager_Lite
                const char* pass )
     {
       ESP_WML_LOGERROR(F("conW"));
+
+#if USING_WIFI_EVENTS
+      beginWiFiEvents();
+#endif
+
+#if USING_NONBLOCKING_CONNECT
+      // As the only credentials. Only start : connected by run(), retried every WIFI_RECON_INTERVAL if it fails
+      memset(ESP_WM_LITE_config.WiFi_Creds, 0, sizeof(ESP_WM_LITE_config.WiFi_Creds));
+      copyConfigValue(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, sizeof(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid), ssid);
+      copyConfigValue(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw, sizeof(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw),
+                      pass ? pass : "");
+
+      _directConnect = true;
+
+      if (static_IP != IPAddress(0, 0, 0, 0))
+      {
+        ESP_WML_LOGINFO(F("UseStatIP"));
+        WiFi.config(static_IP, static_GW, static_SN, static_DNS1, static_DNS2);
+      }
+
+      startConnectAttempt(0, false);
+#else
       connectWiFi(ssid, pass);
+#endif
     }
 
     //////////////////////////////////////////
@@ -666,14 +1453,19 @@ class ESPAsync_WiFiManager_Lite
   #define REQUIRE_ONE_SET_SSID_PW     false
 #endif
 
+// First WiFi_Creds[] sets marked as required. All of them must be valid, unless REQUIRE_ONE_SET_SSID_PW
+#if ( REQUIRE_ONE_SET_SSID_PW || (NUM_WIFI_CREDENTIALS < 2) )
+  #define NUM_REQUIRED_WIFI_CREDENTIALS   1
+#else
+  #define NUM_REQUIRED_WIFI_CREDENTIALS   2
+#endif
+
 #define PASSWORD_MIN_LEN        8
 
     //////////////////////////////////////////
 
     void begin(const char *iHostname = "")
     {
-#define TIMEOUT_CONNECT_WIFI      30000
-
 #if USE_LED_BUILTIN
       // Turn OFF
       pinMode(LED_BUILTIN, OUTPUT);
@@ -724,8 +1516,16 @@ class ESPAsync_WiFiManager_Lite
 
       ESP_WML_LOGINFO1(F("Hostname="), RFC952_hostname);
 
+#if USING_WIFI_EVENTS
+      beginWiFiEvents();
+#endif
+
       hadConfigData = getConfigData();
 
+#if USING_HOT_APPLY
+      saveAppliedConfig();
+#endif
+
       isForcedConfigPortal = isForcedCP();
 
       //// New DRD/MRD ////
@@ -736,21 +1536,14 @@ class ESPAsync_WiFiManager_Lite
 
         ESP_WML_LOGDEBUG(noConfigPortal ? F("bg: noConfigPortal = true") : F("bg: noConfigPortal = false"));
 
-        for (uint16_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
-        {
-          if ( strlen(ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw) >= PASSWORD_MIN_LEN )
-          {
-            ESP_WML_LOGDEBUG5(F("bg: addAP : index="), i, F(", SSID="), ESP_WM_LITE_config.WiFi_Creds[i].wifi_ssid, F(", PWD="),
-                              ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw);
-            wifiMulti.addAP(ESP_WM_LITE_config.WiFi_Creds[i].wifi_ssid, ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw);
-          }
-          else
-          {
-            ESP_WML_LOGWARN3(F("bg: Ignore invalid WiFi PWD : index="), i, F(", PWD="), ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw);
-          }
-        }
-
-        if (connectMultiWiFi() == WL_CONNECTED)
+        addWiFiMultiAPs();
+
+#if USING_NONBLOCKING_CONNECT
+        // Only start. Connected by run(), which starts configuration mode if all credentials fail
+        connectWiFiStep();
+#else
+
+        if (connectMultiWiFi() == WL_CONNECTED)
         {
           ESP_WML_LOGINFO(F("bg: WiFi OK."));
         }
@@ -760,6 +1553,8 @@ class ESPAsync_WiFiManager_Lite
           // failed to connect to WiFi, will start configuration mode
           startConfigurationMode();
         }
+
+#endif
       }
       else
       {
@@ -834,12 +1629,37 @@ class ESPAsync_WiFiManager_Lite
   #endif
 #endif
 
+// Instead of WIFI_RECON_INTERVAL, wait before each reconnection an interval doubled after each failed one,
+// and shortened by a random part, different for each board, so that boards having lost the same AP don't retry together
+#if !defined(USING_RECONNECT_BACKOFF)
+  #define USING_RECONNECT_BACKOFF     false
+#endif
+
+#if USING_RECONNECT_BACKOFF
+  // Defaults of setReconnectBackoff()
+  #if !defined(RECON_BACKOFF_MIN_INTERVAL)
+    #define RECON_BACKOFF_MIN_INTERVAL  1000L     // Before the first reconnection
+  #endif
+
+  #if !defined(RECON_BACKOFF_MAX_INTERVAL)
+    #define RECON_BACKOFF_MAX_INTERVAL  300000L
+  #endif
+
+  // Max random part, in % of the interval
+  #if !defined(RECON_BACKOFF_JITTER)
+    #define RECON_BACKOFF_JITTER        50
+  #endif
+#endif
+
     //////////////////////////////////////////
 
     void run()
     {
+#if (RESET_IF_CONFIG_TIMEOUT && !USING_NONBLOCKING_CONNECT)
       static int retryTimes = 0;
+#endif
 
+#if !USING_WIFI_EVENTS
       static bool wifiDisconnectedOnce = false;
 
       // Lost connection in running. Give chance to reconfig.
@@ -847,10 +1667,7 @@ class ESPAsync_WiFiManager_Lite
       // Check twice to be sure wifi disconnected is real
       static unsigned long checkstatus_timeout = 0;
 #define WIFI_STATUS_CHECK_INTERVAL    5000L
-
-      static uint32_t curMillis;
-
-      curMillis = millis();
+#endif
 
 #if USING_MRD
       //// New MRD ////
@@ -858,7 +1675,9 @@ class ESPAsync_WiFiManager_Lite
       // so that it can recognise when the timeout expires.
       // You can also call mrd.stop() when you wish to no longer
       // consider the next reset as a multi reset.
-      mrd->loop();
+      // Not created by begin(ssid, pass)
+      if (mrd)
+        mrd->loop();
       //// New MRD ////
 #else
       //// New DRD ////
@@ -866,10 +1685,64 @@ class ESPAsync_WiFiManager_Lite
       // so that it can recognise when the timeout expires.
       // You can also call drd.stop() when you wish to no longer
       // consider the next reset as a double reset.
-      drd->loop();
+      // Not created by begin(ssid, pass)
+      if (drd)
+        drd->loop();
       //// New DRD ////
 #endif
 
+#if USING_HOT_APPLY
+
+      if ( _applyPending && (millis() - _applyTime >= HOT_APPLY_DELAY) )
+        applyConfig();
+
+#endif
+
+#if USING_ASYNC_WIFI_SCAN
+
+      if (configuration_mode)
+        pollWiFiScan();
+
+#endif
+
+#if USING_DHCP_CACHE
+      checkLeaseProbe();
+#endif
+
+#if USING_ROAMING
+
+      // The link is down while moving to another AP. If that fails, it is reconnected as usual
+      if (checkRoaming())
+        return;
+
+#endif
+
+#if USING_NONBLOCKING_CONNECT
+
+      // Not while the Config Portal is waiting for the user
+      if ( !( configuration_mode && ( configTimeout == 0 ||  millis() < configTimeout ) ) )
+        connectWiFiStep();
+
+#endif
+
+#if USING_WIFI_EVENTS
+
+      if (!configuration_mode)
+      {
+        const bool linkUp = _linkUp;
+
+        if (wifi_connected && !linkUp)
+        {
+          ESP_WML_LOGERROR1(F("r:WLost,reason="), (uint8_t) _disconnectReason);
+        }
+
+        wifi_connected = linkUp;
+      }
+
+#else
+
+      const uint32_t curMillis = millis();
+
       if ( !configuration_mode && (curMillis > checkstatus_timeout) )
       {
         if (WiFi.status() == WL_CONNECTED)
@@ -893,14 +1766,18 @@ class ESPAsync_WiFiManager_Lite
         checkstatus_timeout = curMillis + WIFI_STATUS_CHECK_INTERVAL;
       }
 
+#endif
+
       // Lost connection in running. Give chance to reconfig.
-      if ( WiFi.status() != WL_CONNECTED )
+      if ( getWiFiLinkStatus() != WL_CONNECTED )
       {
         // If configTimeout but user hasn't connected to configWeb => try to reconnect WiFi
         // But if user has connected to configWeb, stay there until done, then reset hardware
         if ( configuration_mode && ( configTimeout == 0 ||  millis() < configTimeout ) )
         {
+#if (RESET_IF_CONFIG_TIMEOUT && !USING_NONBLOCKING_CONNECT)
           retryTimes = 0;
+#endif
 
           // Fix ESP32-S2 issue with WebServer (https://github.com/espressif/arduino-esp32/issues/4348)
           if ( String(ARDUINO_BOARD) == "ESP32S2_DEV" )
@@ -912,7 +1789,7 @@ class ESPAsync_WiFiManager_Lite
         }
         else
         {
-#if RESET_IF_CONFIG_TIMEOUT
+#if (RESET_IF_CONFIG_TIMEOUT && !USING_NONBLOCKING_CONNECT)
 
           // If we're here but still in configuration_mode, permit running TIMES_BEFORE_RESET times before reset hardware
           // to permit user another chance to config.
@@ -932,12 +1809,40 @@ class ESPAsync_WiFiManager_Lite
 
 #endif
 
+#if !USING_NONBLOCKING_CONNECT
+
           // Not in config mode, try reconnecting before forcing to config mode
-          if ( WiFi.status() != WL_CONNECTED )
+          if ( getWiFiLinkStatus() != WL_CONNECTED )
           {
-#if (WIFI_RECON_INTERVAL > 0)
+#if USING_RECONNECT_BACKOFF
+
+            if (!_reconWaiting)
+              scheduleReconnect();
+
+            if (isReconnectDue())
+            {
+              ESP_WML_LOGERROR1(F("r:WLost.ReconW#"), _reconAttempts);
+
+              if (connectMultiWiFi() == WL_CONNECTED)
+              {
+#if USE_LED_BUILTIN
+                // turn the LED_BUILTIN OFF to tell us we exit configuration mode.
+                digitalWrite(LED_BUILTIN, LED_OFF);
+#endif
+                ESP_WML_LOGINFO(F("run: WiFi reconnected"));
+
+                resetReconnect();
+              }
+              else
+              {
+                scheduleReconnect();
+              }
+            }
+
+#elif (WIFI_RECON_INTERVAL > 0)
 
             static uint32_t lastMillis = 0;
+            const uint32_t curMillis = millis();
 
             if ( (lastMillis == 0) || (curMillis - lastMillis) > WIFI_RECON_INTERVAL )
             {
@@ -970,34 +1875,32 @@ class ESPAsync_WiFiManager_Lite
 #endif
           }
 
+#endif
+
           //ESP_WML_LOGINFO(F("run: Lost connection => configMode"));
           //startConfigurationMode();
         }
       }
+
+#if (USING_RECONNECT_BACKOFF && !USING_NONBLOCKING_CONNECT)
+      else if (_reconWaiting)
+      {
+        // Reconnected by the WiFi auto-reconnect. Start the backoff again from the next loss
+        resetReconnect();
+      }
+#endif
+
+#if USING_AP_STA_PORTAL
+      // The STA stays connected under the Config Portal. Closed by a save, or when timed out
+      else if ( configuration_mode && (configTimeout != 0) && (millis() >= configTimeout) )
+#else
       else if (configuration_mode)
+#endif
       {
         // WiFi is connected and we are in configuration_mode
-        configuration_mode = false;
         ESP_WML_LOGINFO(F("run: got WiFi back"));
 
-#if USE_LED_BUILTIN
-        // turn the LED_BUILTIN OFF to tell us we exit configuration mode.
-        digitalWrite(LED_BUILTIN, LED_OFF);
-#endif
-
-        if (dnsServer)
-        {
-          dnsServer->stop();
-          delete dnsServer;
-          dnsServer = nullptr;
-        }
-
-        if (server)
-        {
-          server->end();
-          delete server;
-          server = nullptr;
-        }
+        stopConfigurationMode();
       }
     }
 
@@ -1132,6 +2035,145 @@ class ESPAsync_WiFiManager_Lite
 
     //////////////////////////////////////////////
 
+#if USING_NONBLOCKING_CONNECT
+
+    ESP_WM_LITE_Connect_State getConnectState()
+    {
+      return _connectState;
+    }
+
+    //////////////////////////////////////////////
+
+    // Index in WiFi_Creds[] of the credentials being tried, or used once connected
+    uint8_t getConnectIndex()
+    {
+      return _connectIndex;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if USING_RECONNECT_BACKOFF
+
+    // Wait minInterval before the first reconnection, doubled after each failed one up to maxInterval.
+    // Each wait is shortened by a random part, up to jitterPercent % of it
+    void setReconnectBackoff(const uint32_t& minInterval, const uint32_t& maxInterval,
+                             const uint8_t& jitterPercent = RECON_BACKOFF_JITTER)
+    {
+      _reconMinInterval = minInterval;
+      _reconMaxInterval = (maxInterval > minInterval) ? maxInterval : minInterval;
+      _reconJitter      = (jitterPercent > 100) ? 100 : jitterPercent;
+    }
+
+    //////////////////////////////////////////////
+
+    // Reconnections started since the WiFi was lost, 0 once connected
+    uint16_t getReconnectAttempts()
+    {
+      return _reconAttempts;
+    }
+
+    //////////////////////////////////////////////
+
+    // All reconnections started since begin()
+    uint32_t getReconnectTotalAttempts()
+    {
+      return _reconTotalAttempts;
+    }
+
+    //////////////////////////////////////////////
+
+    // ms until the next reconnection, 0 if not waiting
+    uint32_t getNextReconnectIn()
+    {
+      if (!_reconWaiting)
+        return 0;
+
+      const uint32_t waited = millis() - _reconWaitStart;
+
+      return (waited >= _reconWait) ? 0 : _reconWait - waited;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if USING_ROAMING
+
+    // Background scans, and moves to another AP, since begin()
+    uint32_t getRoamScans()
+    {
+      return _roamScans;
+    }
+
+    //////////////////////////////////////////////
+
+    uint32_t getRoamMoves()
+    {
+      return _roamMoves;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if USING_WRITE_AVOIDANCE
+
+    // Files or EEPROM commits written, and skipped as unchanged, since begin()
+    uint32_t getStorageWrites()
+    {
+      return _storageWrites;
+    }
+
+    //////////////////////////////////////////////
+
+    uint32_t getStorageWritesSkipped()
+    {
+      return _storageWritesSkipped;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if USING_WIFI_EVENTS
+
+    // Reason of the last STA disconnection, 0 if none. wifi_err_reason_t for ESP32, WiFiDisconnectReason for ESP8266
+    uint8_t getWiFiDisconnectReason()
+    {
+      return _disconnectReason;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+    // WiFi_Creds[] index of the credentials tried at position rank of a connection pass
+    uint8_t getCredsOrder(const uint8_t& rank)
+    {
+#if USING_CREDS_RANKING
+      if (rank < NUM_WIFI_CREDENTIALS)
+        return _credsOrder[rank];
+#endif
+
+      return rank;
+    }
+
+    //////////////////////////////////////////////
+
+#if USING_CREDS_RANKING
+
+    // Statistics of WiFi_Creds[index], NULL if index invalid
+    const ESP_WM_LITE_Creds_Stats* getCredsStats(const uint8_t& index)
+    {
+      return (index < NUM_WIFI_CREDENTIALS) ? &_credsStats[index] : NULL;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
     ESP_WM_LITE_Configuration* getFullConfigData(ESP_WM_LITE_Configuration *configData)
     {
       if (!hadConfigData)
@@ -1188,6 +2230,45 @@ class ESPAsync_WiFiManager_Lite
 
     //////////////////////////////////////////////
 
+#if USING_CAPTIVE_PROBE_ROUTES
+
+    // Probe routes, in ESP_WM_LITE_PROBE_ROUTES order, and how many times each was hit
+    uint8_t getNumProbeRoutes()
+    {
+      return NUM_PROBE_ROUTES;
+    }
+
+    String getProbeRoute(const uint8_t& route)
+    {
+      return (route < NUM_PROBE_ROUTES) ? String(FPSTR(ESP_WM_LITE_PROBE_ROUTES[route].path)) : String("");
+    }
+
+    uint32_t getProbeHits(const uint8_t& route)
+    {
+      return (route < NUM_PROBE_ROUTES) ? _probeHits[route] : 0;
+    }
+
+#endif
+
+    //////////////////////////////////////////////
+
+#if USING_HTML_CACHE
+
+    // Config Portal page requests served from cache (including 304), and requests that had to render the page
+    uint32_t getHTMLCacheHits()
+    {
+      return _htmlCacheHits;
+    }
+
+    uint32_t getHTMLCacheMisses()
+    {
+      return _htmlCacheMisses;
+    }
+
+#endif
+
+    //////////////////////////////////////////////
+
     // Forced CP => Flag = 0xBEEFBEEF. Else => No forced CP
     // Flag to be stored at (EEPROM_START + DRD_FLAG_DATA_SIZE + CONFIG_DATA_SIZE)
     // to avoid corruption to current data
@@ -1224,6 +2305,30 @@ class ESPAsync_WiFiManager_Lite
 
     //////////////////////////////////////////////
 
+#if USING_AP_STA_PORTAL
+
+    // Open the Config Portal now, keeping the WiFi connection. Closed by a save, or after CONFIG_TIMEOUT
+    void startConfigPortal()
+    {
+      if (!configuration_mode)
+        startConfigurationMode();
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if USING_HOT_APPLY
+
+    void setMenuItemChangeCallback(ESP_WM_LITE_Change_Callback callback)
+    {
+      _menuItemChangeCallback = callback;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
     void resetFunc()
     {
       delay(1000);
@@ -1388,41 +2493,190 @@ class ESPAsync_WiFiManager_Lite
     String macAddress = "";
     bool wifi_connected = false;
 
-    IPAddress portal_apIP = IPAddress(192, 168, 4, 1);
-    int WiFiAPChannel = 10;
+#if USING_NONBLOCKING_CONNECT
+    ESP_WM_LITE_Connect_State _connectState = WM_CONNECT_IDLE;
+    uint8_t _connectIndex = 0;              // WiFi_Creds[] being tried
+    uint8_t _connectRank = 0;               // Its position in the order of getCredsOrder()
+    unsigned long _connectStart = 0;        // millis() when _connectState was entered
+    bool _connectedOnce = false;
+    uint8_t _connectPassFailures = 0;       // Passes over all credentials failed since the Config Portal timed out
+    bool _directConnect = false;            // WiFi_Creds[0] only, from begin(ssid, pass)
+
+#if USING_FAST_CONNECT
+    bool _fastConnecting = false;           // Directed WiFi.begin() to the AP of the last connection in progress
+#endif
 
-    String portal_ssid = "";
-    String portal_pass = "";
+#if USING_SCAN_CONNECT
+    bool _scanConnecting = false;           // Directed WiFi.begin() to the AP found by the scan in progress
 
-    IPAddress static_IP   = IPAddress(0, 0, 0, 0);
-    IPAddress static_GW   = IPAddress(0, 0, 0, 0);
-    IPAddress static_SN   = IPAddress(255, 255, 255, 0);
-    IPAddress static_DNS1 = IPAddress(0, 0, 0, 0);
-    IPAddress static_DNS2 = IPAddress(0, 0, 0, 0);
+#if ESP8266
+    bool _scanConnectTimedOut = false;      // Scan still running after SCAN_CONNECT_TIMEOUT
+#endif
 
-    /////////////////////////////////////
+#endif
+#endif
 
-    // Add customs headers from v1.2.0
+#if USING_SCAN_CONNECT
+    uint8_t _lastBSSID[6];                  // AP of the last connection, valid if _hasLastBSSID
+    bool    _hasLastBSSID = false;
+#endif
 
-#if USING_CUSTOMS_STYLE
-    PGM_P _CustomsHeadStyle = nullptr;
+    uint16_t _itemsUpdated = 0;             // Fields got by handleRequest() since the last save
+    bool     _configItemUpdated [NUM_CONFIGURABLE_ITEMS] = { false };
+
+#if USING_HOT_APPLY
+    volatile bool _applyPending = false;    // Config Data saved from the web server's task. Applied by run()
+    unsigned long _applyTime    = 0;        // millis() of the save
+    WiFi_Credentials _appliedCreds [NUM_WIFI_CREDENTIALS];      // In use, to tell which changed
+    uint32_t* _menuItemHashes = NULL;       // hashBytes() of each MenuItem's data in use
+    ESP_WM_LITE_Change_Callback _menuItemChangeCallback = NULL;
+
+    ESP_WM_LITE_Configuration _stagedConfig;  // Written by the Config Portal's handlers, taken over by applyConfig()
+
+#if USE_DYNAMIC_PARAMETERS
+    char* _stagedMenuData = NULL;           // Same for the MenuItems' data, [maxlen + 1] bytes each
 #endif
 
-#if USING_CUSTOMS_HEAD_ELEMENT
-    PGM_P _CustomsHeadElement = nullptr;
 #endif
 
-#if USING_CORS_FEATURE
-    PGM_P _CORS_Header = WM_HTTP_CORS_ALLOW_ALL;   // "*";
+#if USING_WRITE_AVOIDANCE
+    uint32_t _storageWrites         = 0;
+    uint32_t _storageWritesSkipped  = 0;
 #endif
 
-    //////////////////////////////////////
-    // Add WiFi Scan from v1.5.0
+#if USING_AB_RECORD_STORAGE
+    bool      _hasRecord        = false;    // A record was loaded or saved. Else the files of previous versions are used
+    uint8_t   _recordSlot       = 0;        // Of the newest record. The next save goes to the other slot
+    uint32_t  _recordSequence   = 0;
+    uint32_t  _recordCPFlag     = 0;        // Forced CP flag in the record
+#endif
 
-#if SCAN_WIFI_NETWORKS
-    int WiFiNetworksFound = 0;    // Number of SSIDs found by WiFi scan, including low quality and duplicates
-    int *indices;                 // WiFi network data, filled by scan (SSID, BSSID)
-    String ListOfSSIDs = "";      // List of SSIDs found by scan, in HTML <option> format
+#if USING_ROAMING
+    int32_t       _roamRSSI       = 0;      // Smoothed WiFi.RSSI(), 0 if no sample yet
+    uint8_t       _roamLowSamples = 0;
+    bool          _roamScanning   = false;
+    bool          _roaming        = false;  // WiFi.begin() to the new AP in progress
+    unsigned long _roamLastSample = 0;
+    unsigned long _roamLastScan   = 0;
+    unsigned long _roamLastMove   = 0;
+    uint32_t      _roamScans      = 0;
+    uint32_t      _roamMoves      = 0;
+#endif
+
+#if USING_WIFI_EVENTS
+    std::atomic<bool>     _linkUp { false };              // Has IP. Set by the WiFi events
+    std::atomic<uint8_t>  _disconnectReason { 0 };
+    bool _wifiEventsStarted = false;
+
+#if ESP8266
+    // Callbacks are removed when these are destroyed
+    WiFiEventHandler _gotIPHandler;
+    WiFiEventHandler _disconnectedHandler;
+#endif
+#endif
+
+#if USING_RECONNECT_BACKOFF
+    uint32_t _reconMinInterval  = RECON_BACKOFF_MIN_INTERVAL;
+    uint32_t _reconMaxInterval  = RECON_BACKOFF_MAX_INTERVAL;
+    uint8_t  _reconJitter       = RECON_BACKOFF_JITTER;
+
+    bool     _reconWaiting      = false;
+    uint32_t _reconWaitStart    = 0;
+    uint32_t _reconWait         = 0;
+    uint16_t _reconAttempts     = 0;
+    uint32_t _reconTotalAttempts = 0;
+    uint32_t _reconRandom       = 0;        // State of reconnectRandom(), from the chip ID
+#endif
+
+#if USING_CREDS_RANKING
+    ESP_WM_LITE_Creds_Stats _credsStats [NUM_WIFI_CREDENTIALS] = {};
+    uint8_t _credsOrder [NUM_WIFI_CREDENTIALS] = {};     // WiFi_Creds[] indexes, best first. Set by rankCredentials()
+    unsigned long _credsAttemptStart = 0;   // millis() of the WiFi.begin() or wifiMulti.run() being timed
+#endif
+
+#if USING_DHCP_CACHE
+    bool _usingCachedLease = false;         // Set as static IP by beginFastConnect()
+    bool _leaseProbing = false;
+    volatile bool _leaseConflict = false;   // Another host answered for our IP. Set from the lwIP thread on ESP32
+    uint32_t _leaseProbeIP = 0;
+    unsigned long _leaseProbeStart = 0;
+    unsigned long _leaseProbeLast = 0;
+    uint32_t _leaseAge = 0;                 // leaseAge of the cached lease when connected with it
+    unsigned long _leaseAgeSaved = 0;       // millis() when _leaseAge was last recorded
+#endif
+
+    IPAddress portal_apIP = IPAddress(192, 168, 4, 1);
+    int WiFiAPChannel = 10;
+
+    String portal_ssid = "";
+    String portal_pass = "";
+
+    IPAddress static_IP   = IPAddress(0, 0, 0, 0);
+    IPAddress static_GW   = IPAddress(0, 0, 0, 0);
+    IPAddress static_SN   = IPAddress(255, 255, 255, 0);
+    IPAddress static_DNS1 = IPAddress(0, 0, 0, 0);
+    IPAddress static_DNS2 = IPAddress(0, 0, 0, 0);
+
+    /////////////////////////////////////
+
+    // Add customs headers from v1.2.0
+
+#if USING_CUSTOMS_STYLE
+    PGM_P _CustomsHeadStyle = nullptr;
+#endif
+
+#if USING_CUSTOMS_HEAD_ELEMENT
+    PGM_P _CustomsHeadElement = nullptr;
+#endif
+
+#if USING_CORS_FEATURE
+    PGM_P _CORS_Header = WM_HTTP_CORS_ALLOW_ALL;   // "*";
+#endif
+
+    //////////////////////////////////////
+    // Add WiFi Scan from v1.5.0
+
+#if SCAN_WIFI_NETWORKS
+    int WiFiNetworksFound = 0;    // Number of SSIDs found by WiFi scan, including low quality and duplicates
+    int *indices = NULL;          // WiFi network data, filled by scan (SSID, BSSID)
+    String ListOfSSIDs = "";      // List of SSIDs found by scan, in HTML <option> format
+
+#if USING_ASYNC_WIFI_SCAN
+    bool _scanRunning = false;    // Background scan started by startConfigurationMode(), not yet processed
+#endif
+
+#if USING_SCAN_CACHE
+    ESP_WM_LITE_Scan_Result* _scanCache = nullptr;   // Sorted by RSSI, strongest first
+    uint8_t _numScanCache = 0;
+    bool _scanCacheFilled = false;                    // Even with no network found
+    unsigned long _scanCacheTime = 0;                 // millis() of the last fill
+#endif
+#endif
+
+#if ESP32
+    SemaphoreHandle_t _portalMutex = nullptr;       // Held through ESP_WM_LITE_LOCK_PORTAL()
+#endif
+
+    //////////////////////////////////////
+    // Parsed Config Portal page template, built on first use
+
+    char* _htmlBuffer = nullptr;                    // Template with each slot marker cut off by a NULL
+    ESP_WM_LITE_HTML_Span* _htmlSpans = nullptr;    // Literal spans and slots, in page order
+    uint16_t _numHtmlSpans = 0;
+    uint16_t _htmlLiteralsLength = 0;               // Sum of all literal spans' lengths
+
+#if USING_CAPTIVE_PROBE_ROUTES
+    String _portalURL;                              // Redirect target of the probe routes
+    uint32_t _probeHits[NUM_PROBE_ROUTES] = { 0 };
+#endif
+
+#if USING_HTML_CACHE
+    std::shared_ptr<String> _htmlCache;             // Last rendered page, shared with responses still sending it
+    uint32_t _htmlCacheKey = 0;                     // Hash of the data the cached page was rendered from
+    char _htmlETag[11] = "";                        // Quoted hex hash of the last rendered page
+    uint32_t _htmlETagKey = 0;                      // Cache key of the data the last page was rendered from
+    uint32_t _htmlCacheHits = 0;
+    uint32_t _htmlCacheMisses = 0;
 #endif
 
     //////////////////////////////////////
@@ -1459,9 +2713,13 @@ class ESPAsync_WiFiManager_Lite
 
     void displayConfigData(const ESP_WM_LITE_Configuration& configData)
     {
-      ESP_WML_LOGERROR5(F("Hdr="),   configData.header, F(",SSID="), configData.WiFi_Creds[0].wifi_ssid,
-                        F(",PW="),   configData.WiFi_Creds[0].wifi_pw);
-      ESP_WML_LOGERROR3(F("SSID1="), configData.WiFi_Creds[1].wifi_ssid, F(",PW1="),  configData.WiFi_Creds[1].wifi_pw);
+      ESP_WML_LOGERROR1(F("Hdr="),   configData.header);
+
+      for (uint8_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
+      {
+        ESP_WML_LOGERROR5(F("i="), i, F(",SSID="), configData.WiFi_Creds[i].wifi_ssid, F(",PW="), configData.WiFi_Creds[i].wifi_pw);
+      }
+
       ESP_WML_LOGERROR1(F("BName="), configData.board_name);
 
 #if USE_DYNAMIC_PARAMETERS
@@ -1487,11 +2745,73 @@ class ESPAsync_WiFiManager_Lite
 #define ESP_WM_LITE_BOARD_TYPE   "ESP_WM_LITE"
 #define WM_NO_CONFIG             "blank"
 
+// Format of the stored data, in header[] after the NULL of ESP_WM_LITE_BOARD_TYPE. Zero in data from previous versions
+#define ESP_WM_LITE_FORMAT_INDEX      sizeof(ESP_WM_LITE_BOARD_TYPE)
+#define ESP_WM_LITE_FORMAT_SUM        0
+#define ESP_WM_LITE_FORMAT_CRC32      1
+
+#if USING_CRC32_CHECKSUM
+  #define ESP_WM_LITE_FORMAT          ESP_WM_LITE_FORMAT_CRC32
+#else
+  #define ESP_WM_LITE_FORMAT          ESP_WM_LITE_FORMAT_SUM
+#endif
+
+    // Same as crc32_le() of ESP32 ROM : CRC-32 of zlib, chained by passing the previous result as crc
+    uint32_t calcCRC32(uint32_t crc, const void* data, const size_t& len)
+    {
+#ifdef ESP8266
+      const uint8_t* _pointer = (const uint8_t*) data;
+      size_t remaining = len;
+
+      crc = ~crc;
+
+      while (remaining >= 4)
+      {
+        crc ^= (uint32_t) _pointer[0] | ( (uint32_t) _pointer[1] << 8 ) |
+               ( (uint32_t) _pointer[2] << 16 ) | ( (uint32_t) _pointer[3] << 24 );
+
+        crc = pgm_read_dword(&ESP_WM_LITE_CRC32_TABLE[3][crc & 0xFF])           ^
+              pgm_read_dword(&ESP_WM_LITE_CRC32_TABLE[2][(crc >> 8) & 0xFF])    ^
+              pgm_read_dword(&ESP_WM_LITE_CRC32_TABLE[1][(crc >> 16) & 0xFF])   ^
+              pgm_read_dword(&ESP_WM_LITE_CRC32_TABLE[0][crc >> 24]);
+
+        _pointer  += 4;
+        remaining -= 4;
+      }
+
+      while (remaining--)
+      {
+        crc = pgm_read_dword(&ESP_WM_LITE_CRC32_TABLE[0][(crc ^ *_pointer++) & 0xFF]) ^ (crc >> 8);
+      }
+
+      return ~crc;
+#else
+      return ESP_WM_LITE_ROM_CRC32_LE(crc, (const uint8_t*) data, len);
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+    bool isCRC32Format()
+    {
+      return (ESP_WM_LITE_config.header[ESP_WM_LITE_FORMAT_INDEX] == ESP_WM_LITE_FORMAT_CRC32);
+    }
+
+    //////////////////////////////////////////////
+
+    // Checksum of ESP_WM_LITE_config, in the format of its header[]. Set to ESP_WM_LITE_FORMAT before saving
     int calcChecksum()
     {
+      const size_t len = sizeof(ESP_WM_LITE_config) - sizeof(ESP_WM_LITE_config.checkSum);
+
+      if (isCRC32Format())
+      {
+        return (int) calcCRC32(0, &ESP_WM_LITE_config, len);
+      }
+
       int checkSum = 0;
 
-      for (uint16_t index = 0; index < (sizeof(ESP_WM_LITE_config) - sizeof(ESP_WM_LITE_config.checkSum)); index++)
+      for (uint16_t index = 0; index < len; index++)
       {
         checkSum += * ( ( (byte*) &ESP_WM_LITE_config ) + index);
       }
@@ -1501,31 +2821,36 @@ class ESPAsync_WiFiManager_Lite
 
     //////////////////////////////////////////////
 
+    // SSID not "blank" nor NULL, and PWD length >= 8 (as required by standard)
+    bool isWiFiCredsValid(const WiFi_Credentials& creds)
+    {
+      return ( strncmp(creds.wifi_ssid, WM_NO_CONFIG, strlen(WM_NO_CONFIG)) && (strlen(creds.wifi_ssid) > 0) &&
+               strncmp(creds.wifi_pw,   WM_NO_CONFIG, strlen(WM_NO_CONFIG)) && (strlen(creds.wifi_pw) >= PASSWORD_MIN_LEN) );
+    }
+
+    //////////////////////////////////////////////
+
     bool isWiFiConfigValid()
     {
 #if REQUIRE_ONE_SET_SSID_PW
 
-      // If SSID ="blank" or NULL, or PWD length < 8 (as required by standard) => return false
-      // Only need 1 set of valid SSID/PWD
-      if (!( ( ( strncmp(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, WM_NO_CONFIG, strlen(WM_NO_CONFIG))
-                 && strlen(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid) >  0 )  &&
-               (   strlen(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw) >= PASSWORD_MIN_LEN ) ) ||
-             ( ( strncmp(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid, WM_NO_CONFIG, strlen(WM_NO_CONFIG))
-                 && strlen(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid) >  0 )  &&
-               ( strlen(ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw) >= PASSWORD_MIN_LEN ) ) ))
+      // Only need 1 set of valid SSID/PWD, any of them
+      bool valid = false;
+
+      for (uint8_t i = 0; (i < NUM_WIFI_CREDENTIALS) && !valid; i++)
+        valid = isWiFiCredsValid(ESP_WM_LITE_config.WiFi_Creds[i]);
+
 #else
 
-      // If SSID ="blank" or NULL, or PWD length < 8 (as required by standard) => invalid set
-      // Need both sets of valid SSID/PWD
-      if ( !strncmp(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid,   WM_NO_CONFIG, strlen(WM_NO_CONFIG) )  ||
-           !strncmp(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw,     WM_NO_CONFIG, strlen(WM_NO_CONFIG) )  ||
-           !strncmp(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid,   WM_NO_CONFIG, strlen(WM_NO_CONFIG) )  ||
-           !strncmp(ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw,     WM_NO_CONFIG, strlen(WM_NO_CONFIG) )  ||
-           ( strlen(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid) == 0 ) ||
-           ( strlen(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid) == 0 ) ||
-           ( strlen(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw)   < PASSWORD_MIN_LEN ) ||
-           ( strlen(ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw)   < PASSWORD_MIN_LEN ) )
+      // Need the NUM_REQUIRED_WIFI_CREDENTIALS first sets of valid SSID/PWD
+      bool valid = true;
+
+      for (uint8_t i = 0; (i < NUM_REQUIRED_WIFI_CREDENTIALS) && valid; i++)
+        valid = isWiFiCredsValid(ESP_WM_LITE_config.WiFi_Creds[i]);
+
 #endif
+
+      if (!valid)
       {
         // If SSID, PW ="blank" or NULL, set the flag
         ESP_WML_LOGERROR(F("Invalid Stored WiFi Config Data"));
@@ -1543,880 +2868,927 @@ class ESPAsync_WiFiManager_Lite
 
     //////////////////////////////////////////////
 
-#if ( USE_LITTLEFS || USE_SPIFFS )
-
-  // Use LittleFS/InternalFS for nRF52
-  #define  CONFIG_FILENAME                  ("/wm_config.dat")
-  #define  CONFIG_FILENAME_BACKUP           ("/wm_config.bak")
-
-  #define  CREDENTIALS_FILENAME             ("/wm_cred.dat")
-  #define  CREDENTIALS_FILENAME_BACKUP      ("/wm_cred.bak")
-
-  #define  CONFIG_PORTAL_FILENAME           ("/wm_cp.dat")
-  #define  CONFIG_PORTAL_FILENAME_BACKUP    ("/wm_cp.bak")
-
-    //////////////////////////////////////////////
+#if USE_DYNAMIC_PARAMETERS
 
-    void saveForcedCP(const uint32_t& value)
+    // Size of the stored dynamic data : each pdata without its NULL terminator, then the checksum
+    uint16_t dynamicDataSize()
     {
-      File file = FileFS.open(CONFIG_PORTAL_FILENAME, "w");
-
-      ESP_WML_LOGINFO(F("SaveCPFile "));
+      uint16_t len = sizeof(int);
 
-      if (file)
-      {
-        file.write((uint8_t*) &value, sizeof(value));
-        file.close();
-        ESP_WML_LOGINFO(F("OK"));
-      }
-      else
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
       {
-        ESP_WML_LOGINFO(F("failed"));
+        len += myMenuItems[i].maxlen;
       }
 
-      // Trying open redundant CP file
-      file = FileFS.open(CONFIG_PORTAL_FILENAME_BACKUP, "w");
-
-      ESP_WML_LOGINFO(F("SaveBkUpCPFile "));
-
-      if (file)
-      {
-        file.write((uint8_t *) &value, sizeof(value));
-        file.close();
-        ESP_WML_LOGINFO(F("OK"));
-      }
-      else
-      {
-        ESP_WML_LOGINFO(F("failed"));
-      }
+      return len;
     }
 
     //////////////////////////////////////////////
 
-    void setForcedCP(const bool& isPersistent)
+    // Byte-sum of previous versions, of char sign-extended as stored by them
+    int calcDynamicSum(const char* buffer, const uint16_t& len)
     {
-      uint32_t readForcedConfigPortalFlag = isPersistent ? FORCED_PERS_CONFIG_PORTAL_FLAG_DATA :
-                                            FORCED_CONFIG_PORTAL_FLAG_DATA;
+      int checkSum = 0;
 
-      ESP_WML_LOGDEBUG(isPersistent ? F("setForcedCP Persistent") : F("setForcedCP non-Persistent"));
+      for (uint16_t j = 0; j < len; j++)
+      {
+        checkSum += buffer[j];
+      }
 
-      saveForcedCP(readForcedConfigPortalFlag);
+      return checkSum;
     }
 
     //////////////////////////////////////////////
 
-    void clearForcedCP()
+    // Checksum to write of the len bytes of dynamic data stored in one piece in buffer
+    int calcDynamicChecksum(const char* buffer, const uint16_t& len)
     {
-      uint32_t readForcedConfigPortalFlag = 0;
-
-      ESP_WML_LOGDEBUG(F("clearForcedCP"));
-
-      saveForcedCP(readForcedConfigPortalFlag);
+#if USING_CRC32_CHECKSUM
+      return (int) calcCRC32(0, buffer, len);
+#else
+      return calcDynamicSum(buffer, len);
+#endif
     }
 
     //////////////////////////////////////////////
 
-    bool isForcedCP()
+    // Checksum to write of all MenuItems' pdata, same as calcDynamicChecksum() of them stored in one piece
+    int calcMenuItemsChecksum()
     {
-      uint32_t readForcedConfigPortalFlag;
-
-      ESP_WML_LOGDEBUG(F("Check if isForcedCP"));
+#if USING_CRC32_CHECKSUM
+      uint32_t crc = 0;
 
-      File file = FileFS.open(CONFIG_PORTAL_FILENAME, "r");
-      ESP_WML_LOGINFO(F("LoadCPFile "));
-
-      if (!file)
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
       {
-        ESP_WML_LOGINFO(F("failed"));
-
-        // Trying open redundant config file
-        file = FileFS.open(CONFIG_PORTAL_FILENAME_BACKUP, "r");
-        ESP_WML_LOGINFO(F("LoadBkUpCPFile "));
-
-        if (!file)
-        {
-          ESP_WML_LOGINFO(F("failed"));
-          return false;
-        }
+        crc = calcCRC32(crc, myMenuItems[i].pdata, myMenuItems[i].maxlen);
       }
 
-      file.readBytes((char *) &readForcedConfigPortalFlag, sizeof(readForcedConfigPortalFlag));
-
-      ESP_WML_LOGINFO(F("OK"));
-      file.close();
+      return (int) crc;
+#else
+      int checkSum = 0;
 
-      // Return true if forced CP (0xDEADBEEF read at offset EPROM_START + DRD_FLAG_DATA_SIZE + CONFIG_DATA_SIZE)
-      // => set flag noForcedConfigPortal = false
-      if (readForcedConfigPortalFlag == FORCED_CONFIG_PORTAL_FLAG_DATA)
-      {
-        persForcedConfigPortal = false;
-        return true;
-      }
-      else if (readForcedConfigPortalFlag == FORCED_PERS_CONFIG_PORTAL_FLAG_DATA)
-      {
-        persForcedConfigPortal = true;
-        return true;
-      }
-      else
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
       {
-        return false;
+        checkSum += calcDynamicSum(myMenuItems[i].pdata, myMenuItems[i].maxlen);
       }
+
+      return checkSum;
+#endif
     }
 
     //////////////////////////////////////////////
 
-#if USE_DYNAMIC_PARAMETERS
-
-    bool checkDynamicData()
+    // Verify the checksum of the dynamic data read in one piece into buffer, of dynamicDataSize().
+    // CRC32, or the byte-sum if the Config Data is still in the format of previous versions
+    bool isDynamicDataValid(const char* buffer)
     {
-      int checkSum = 0;
+      const uint16_t len = dynamicDataSize() - sizeof(int);
+      int checkSum = (int) calcCRC32(0, buffer, len);
       int readCheckSum;
-      char* readBuffer;
 
-      File file = FileFS.open(CREDENTIALS_FILENAME, "r");
-      ESP_WML_LOGINFO(F("LoadCredFile "));
+      memcpy(&readCheckSum, buffer + len, sizeof(readCheckSum));
 
-      if (!file)
+      if ( (checkSum != readCheckSum) && !isCRC32Format() )
       {
-        ESP_WML_LOGINFO(F("failed"));
-
-        // Trying open redundant config file
-        file = FileFS.open(CREDENTIALS_FILENAME_BACKUP, "r");
-        ESP_WML_LOGINFO(F("LoadBkUpCredFile "));
-
-        if (!file)
-        {
-          ESP_WML_LOGINFO(F("failed"));
-          return false;
-        }
+        checkSum = calcDynamicSum(buffer, len);
       }
 
-      // Find the longest pdata, then dynamically allocate buffer. Remember to free when done
-      // This is used to store tempo data to calculate checksum to see of data is valid
-      // We dont like to destroy myMenuItems[i].pdata with invalid data
+      ESP_WML_LOGINFO3(F("CrCCsum=0x"), String(checkSum, HEX), F(",CrRCsum=0x"), String(readCheckSum, HEX));
+
+      return (checkSum == readCheckSum);
+    }
 
-      uint16_t maxBufferLength = 0;
+    //////////////////////////////////////////////
 
+    // Copy the verified buffer into each MenuItem's pdata. Not touched if the stored data is invalid
+    void scatterDynamicData(const char* buffer)
+    {
       for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
       {
-        if (myMenuItems[i].maxlen > maxBufferLength)
-          maxBufferLength = myMenuItems[i].maxlen;
-      }
+        // Actual size of pdata is [maxlen + 1]
+        memcpy(myMenuItems[i].pdata, buffer, myMenuItems[i].maxlen);
+        myMenuItems[i].pdata[myMenuItems[i].maxlen] = 0;
 
-      if (maxBufferLength > 0)
-      {
-        readBuffer = new char[ maxBufferLength + 1 ];
+        buffer += myMenuItems[i].maxlen;
 
-        // check to see NULL => stop and return false
-        if (readBuffer == NULL)
-        {
-          ESP_WML_LOGERROR(F("ChkCrR: Error can't allocate buffer."));
-          return false;
-        }
-        else
-        {
-          ESP_WML_LOGDEBUG1(F("ChkCrR: Buffer allocated, sz="), maxBufferLength + 1);
-        }
+        ESP_WML_LOGDEBUG3(F("CrR:pdata="), myMenuItems[i].pdata, F(",len="), myMenuItems[i].maxlen);
+      }
+    }
 
-        for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
-        {
-          char* _pointer = readBuffer;
+    //////////////////////////////////////////////
 
-          // Actual size of pdata is [maxlen + 1]
-          memset(readBuffer, 0, myMenuItems[i].maxlen + 1);
+#endif
 
-          file.readBytes(_pointer, myMenuItems[i].maxlen);
+#if USING_WRITE_AVOIDANCE
 
-          ESP_WML_LOGDEBUG3(F("ChkCrR:pdata="), readBuffer, F(",len="), myMenuItems[i].maxlen);
+    // Counts the write, or the skipped one if the stored data is unchanged. Returns true if the write is needed
+    bool needsStorageWrite(const bool& unchanged)
+    {
+      if (unchanged)
+      {
+        _storageWritesSkipped++;
+        ESP_WML_LOGINFO1(F("Unchanged, not written. Skipped="), _storageWritesSkipped);
 
-          for (uint16_t j = 0; j < myMenuItems[i].maxlen; j++, _pointer++)
-          {
-            checkSum += *_pointer;
-          }
-        }
+        return false;
+      }
 
-        file.readBytes((char *) &readCheckSum, sizeof(readCheckSum));
+      _storageWrites++;
 
-        ESP_WML_LOGINFO(F("OK"));
-        file.close();
+      return true;
+    }
 
-        ESP_WML_LOGINFO3(F("CrCCsum=0x"), String(checkSum, HEX), F(",CrRCsum=0x"), String(readCheckSum, HEX));
+    //////////////////////////////////////////////
 
-        // Free buffer
-        delete [] readBuffer;
-        ESP_WML_LOGDEBUG(F("Buffer freed"));
+#endif
 
-        if ( checkSum == readCheckSum)
-        {
-          return true;
-        }
-      }
+#if ( USE_LITTLEFS || USE_SPIFFS )
 
-      return false;
-    }
+  // Use LittleFS/InternalFS for nRF52
+  #define  CONFIG_FILENAME                  ("/wm_config.dat")
+  #define  CONFIG_FILENAME_BACKUP           ("/wm_config.bak")
 
-    //////////////////////////////////////////////
+  #define  CREDENTIALS_FILENAME             ("/wm_cred.dat")
+  #define  CREDENTIALS_FILENAME_BACKUP      ("/wm_cred.bak")
 
-    bool loadDynamicData()
-    {
-      if (hadDynamicData)
-      {
-        return true;
-      }
+  #define  CONFIG_PORTAL_FILENAME           ("/wm_cp.dat")
+  #define  CONFIG_PORTAL_FILENAME_BACKUP    ("/wm_cp.bak")
 
-      int checkSum = 0;
-      int readCheckSum;
-      totalDataSize = sizeof(ESP_WM_LITE_config) + sizeof(readCheckSum);
+    //////////////////////////////////////////////
 
-      File file = FileFS.open(CREDENTIALS_FILENAME, "r");
-      ESP_WML_LOGINFO(F("LoadCredFile "));
+#if USING_WRITE_AVOIDANCE
 
-      if (!file)
-      {
-        ESP_WML_LOGINFO(F("failed"));
+    // Compare the next len bytes of file with data, by small chunks not to need a buffer of the file's size
+    bool fileMatches(File& file, const void* data, const size_t& len)
+    {
+      const uint8_t* _pointer = (const uint8_t*) data;
+      uint8_t readBuffer[32];
+      size_t remaining = len;
 
-        // Trying open redundant config file
-        file = FileFS.open(CREDENTIALS_FILENAME_BACKUP, "r");
-        ESP_WML_LOGINFO(F("LoadBkUpCredFile "));
+      while (remaining > 0)
+      {
+        const size_t chunk = (remaining < sizeof(readBuffer)) ? remaining : sizeof(readBuffer);
 
-        if (!file)
-        {
-          ESP_WML_LOGINFO(F("failed"));
+        if ( (file.read(readBuffer, chunk) != chunk) || (memcmp(readBuffer, _pointer, chunk) != 0) )
           return false;
-        }
-      }
 
-      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
-      {
-        char* _pointer = myMenuItems[i].pdata;
-        totalDataSize += myMenuItems[i].maxlen;
+        _pointer  += chunk;
+        remaining -= chunk;
+      }
 
-        // Actual size of pdata is [maxlen + 1]
-        memset(myMenuItems[i].pdata, 0, myMenuItems[i].maxlen + 1);
+      return true;
+    }
 
-        file.readBytes(_pointer, myMenuItems[i].maxlen);
+    //////////////////////////////////////////////
 
-        ESP_WML_LOGDEBUG3(F("CrR:pdata="), myMenuItems[i].pdata, F(",len="), myMenuItems[i].maxlen);
+    bool isFileUnchanged(const char* filename, const void* data, const size_t& len)
+    {
+      File file = FileFS.open(filename, "r");
 
-        for (uint16_t j = 0; j < myMenuItems[i].maxlen; j++, _pointer++)
-        {
-          checkSum += *_pointer;
-        }
-      }
+      if (!file)
+        return false;
 
-      file.readBytes((char *) &readCheckSum, sizeof(readCheckSum));
+      bool unchanged = (file.size() == len) && fileMatches(file, data, len);
 
-      ESP_WML_LOGINFO(F("OK"));
       file.close();
 
-      ESP_WML_LOGINFO3(F("CrCCsum=0x"), String(checkSum, HEX), F(",CrRCsum=0x"), String(readCheckSum, HEX));
-
-      if ( checkSum != readCheckSum)
-      {
-        return false;
-      }
-
-      hadDynamicData = true;
-      return true;
+      return unchanged;
     }
 
     //////////////////////////////////////////////
 
-    void saveDynamicData()
+#endif
+
+    void saveForcedCP(const uint32_t& value)
     {
-      int checkSum = 0;
+#if USING_AB_RECORD_STORAGE
+      _recordCPFlag = value;
 
-      File file = FileFS.open(CREDENTIALS_FILENAME, "w");
-      ESP_WML_LOGINFO(F("SaveCredFile "));
+      saveRecord();
+#else
 
-      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+#if USING_WRITE_AVOIDANCE
+      if (needsStorageWrite(isFileUnchanged(CONFIG_PORTAL_FILENAME, &value, sizeof(value))))
+#endif
       {
-        char* _pointer = myMenuItems[i].pdata;
+        File file = FileFS.open(CONFIG_PORTAL_FILENAME, "w");
 
-        ESP_WML_LOGDEBUG3(F("CW1:pdata="), myMenuItems[i].pdata, F(",len="), myMenuItems[i].maxlen);
+        ESP_WML_LOGINFO(F("SaveCPFile "));
 
         if (file)
         {
-          file.write((uint8_t*) _pointer, myMenuItems[i].maxlen);
+          file.write((uint8_t*) &value, sizeof(value));
+          file.close();
+          ESP_WML_LOGINFO(F("OK"));
         }
         else
         {
           ESP_WML_LOGINFO(F("failed"));
         }
-
-        for (uint16_t j = 0; j < myMenuItems[i].maxlen; j++, _pointer++)
-        {
-          checkSum += *_pointer;
-        }
-      }
-
-      if (file)
-      {
-        file.write((uint8_t*) &checkSum, sizeof(checkSum));
-        file.close();
-        ESP_WML_LOGINFO(F("OK"));
-      }
-      else
-      {
-        ESP_WML_LOGINFO(F("failed"));
       }
 
-      ESP_WML_LOGINFO1(F("CrWCSum=0x"), String(checkSum, HEX));
-
-      // Trying open redundant Auth file
-      file = FileFS.open(CREDENTIALS_FILENAME_BACKUP, "w");
-      ESP_WML_LOGINFO(F("SaveBkUpCredFile "));
-
-      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+#if USING_WRITE_AVOIDANCE
+      if (needsStorageWrite(isFileUnchanged(CONFIG_PORTAL_FILENAME_BACKUP, &value, sizeof(value))))
+#endif
       {
-        char* _pointer = myMenuItems[i].pdata;
+        // Trying open redundant CP file
+        File file = FileFS.open(CONFIG_PORTAL_FILENAME_BACKUP, "w");
 
-        ESP_WML_LOGDEBUG3(F("CW2:pdata="), myMenuItems[i].pdata, F(",len="), myMenuItems[i].maxlen);
+        ESP_WML_LOGINFO(F("SaveBkUpCPFile "));
 
         if (file)
         {
-          file.write((uint8_t*) _pointer, myMenuItems[i].maxlen);
+          file.write((uint8_t *) &value, sizeof(value));
+          file.close();
+          ESP_WML_LOGINFO(F("OK"));
         }
         else
         {
           ESP_WML_LOGINFO(F("failed"));
         }
-
-        for (uint16_t j = 0; j < myMenuItems[i].maxlen; j++, _pointer++)
-        {
-          checkSum += *_pointer;
-        }
       }
 
-      if (file)
-      {
-        file.write((uint8_t*) &checkSum, sizeof(checkSum));
-        file.close();
-        ESP_WML_LOGINFO(F("OK"));
-      }
-      else
-      {
-        ESP_WML_LOGINFO(F("failed"));
-      }
-    }
 #endif
+    }
 
     //////////////////////////////////////////////
 
-    void NULLTerminateConfig()
+    void setForcedCP(const bool& isPersistent)
     {
-      //#define HEADER_MAX_LEN      16
-      //#define SERVER_MAX_LEN      32
-      //#define TOKEN_MAX_LEN       36
+      uint32_t readForcedConfigPortalFlag = isPersistent ? FORCED_PERS_CONFIG_PORTAL_FLAG_DATA :
+                                            FORCED_CONFIG_PORTAL_FLAG_DATA;
 
-      // NULL Terminating to be sure
-      ESP_WM_LITE_config.header[HEADER_MAX_LEN - 1] = 0;
-      ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid[SSID_MAX_LEN - 1] = 0;
-      ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw  [PASS_MAX_LEN - 1] = 0;
-      ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid[SSID_MAX_LEN - 1] = 0;
-      ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw  [PASS_MAX_LEN - 1] = 0;
-      ESP_WM_LITE_config.board_name[BOARD_NAME_MAX_LEN - 1]  = 0;
+      ESP_WML_LOGDEBUG(isPersistent ? F("setForcedCP Persistent") : F("setForcedCP non-Persistent"));
+
+      saveForcedCP(readForcedConfigPortalFlag);
     }
 
     //////////////////////////////////////////////
 
-    bool loadConfigData()
+    void clearForcedCP()
     {
-      File file = FileFS.open(CONFIG_FILENAME, "r");
-      ESP_WML_LOGINFO(F("LoadCfgFile "));
+      uint32_t readForcedConfigPortalFlag = 0;
+
+      ESP_WML_LOGDEBUG(F("clearForcedCP"));
+
+      saveForcedCP(readForcedConfigPortalFlag);
+    }
+
+    //////////////////////////////////////////////
+
+    // Forced CP flag of CONFIG_PORTAL_FILENAME, or of its backup. 0 if none
+    uint32_t readCPFile()
+    {
+      uint32_t readForcedConfigPortalFlag = 0;
+
+      File file = FileFS.open(CONFIG_PORTAL_FILENAME, "r");
+      ESP_WML_LOGINFO(F("LoadCPFile "));
 
       if (!file)
       {
         ESP_WML_LOGINFO(F("failed"));
 
         // Trying open redundant config file
-        file = FileFS.open(CONFIG_FILENAME_BACKUP, "r");
-        ESP_WML_LOGINFO(F("LoadBkUpCfgFile "));
+        file = FileFS.open(CONFIG_PORTAL_FILENAME_BACKUP, "r");
+        ESP_WML_LOGINFO(F("LoadBkUpCPFile "));
 
         if (!file)
         {
           ESP_WML_LOGINFO(F("failed"));
-          return false;
+          return 0;
         }
       }
 
-      file.readBytes((char *) &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config));
+      file.readBytes((char *) &readForcedConfigPortalFlag, sizeof(readForcedConfigPortalFlag));
 
       ESP_WML_LOGINFO(F("OK"));
       file.close();
 
-      return isWiFiConfigValid();
+      return readForcedConfigPortalFlag;
     }
 
     //////////////////////////////////////////////
 
-    void saveConfigData()
+    bool isForcedCP()
     {
-      File file = FileFS.open(CONFIG_FILENAME, "w");
-      ESP_WML_LOGINFO(F("SaveCfgFile "));
+      uint32_t readForcedConfigPortalFlag;
 
-      int calChecksum = calcChecksum();
-      ESP_WM_LITE_config.checkSum = calChecksum;
-      ESP_WML_LOGINFO1(F("WCSum=0x"), String(calChecksum, HEX));
+      ESP_WML_LOGDEBUG(F("Check if isForcedCP"));
 
-      if (file)
-      {
-        file.write((uint8_t*) &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config));
-        file.close();
-        ESP_WML_LOGINFO(F("OK"));
-      }
-      else
+#if USING_AB_RECORD_STORAGE
+
+      // Loaded with the record by getConfigData()
+      if (_hasRecord)
       {
-        ESP_WML_LOGINFO(F("failed"));
+        if ( (_recordCPFlag == FORCED_CONFIG_PORTAL_FLAG_DATA) || (_recordCPFlag == FORCED_PERS_CONFIG_PORTAL_FLAG_DATA) )
+        {
+          persForcedConfigPortal = (_recordCPFlag == FORCED_PERS_CONFIG_PORTAL_FLAG_DATA);
+          return true;
+        }
+
+        return false;
       }
 
-      // Trying open redundant Auth file
-      file = FileFS.open(CONFIG_FILENAME_BACKUP, "w");
-      ESP_WML_LOGINFO(F("SaveBkUpCfgFile "));
+#endif
 
-      if (file)
+      readForcedConfigPortalFlag = readCPFile();
+
+      // Return true if forced CP (0xDEADBEEF read at offset EPROM_START + DRD_FLAG_DATA_SIZE + CONFIG_DATA_SIZE)
+      // => set flag noForcedConfigPortal = false
+      if (readForcedConfigPortalFlag == FORCED_CONFIG_PORTAL_FLAG_DATA)
       {
-        file.write((uint8_t *) &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config));
-        file.close();
-        ESP_WML_LOGINFO(F("OK"));
+        persForcedConfigPortal = false;
+        return true;
+      }
+      else if (readForcedConfigPortalFlag == FORCED_PERS_CONFIG_PORTAL_FLAG_DATA)
+      {
+        persForcedConfigPortal = true;
+        return true;
       }
       else
       {
-        ESP_WML_LOGINFO(F("failed"));
+        return false;
       }
     }
 
     //////////////////////////////////////////////
 
-    void saveAllConfigData()
+#if USE_DYNAMIC_PARAMETERS
+
+    // One open and one read of the whole dynamic data file into buffer, of dynamicDataSize()
+    bool readDynamicDataFile(char* buffer, const uint16_t& len)
     {
-      saveConfigData();
+      File file = FileFS.open(CREDENTIALS_FILENAME, "r");
+      ESP_WML_LOGINFO(F("LoadCredFile "));
 
-#if USE_DYNAMIC_PARAMETERS
-      saveDynamicData();
-#endif
+      if (!file)
+      {
+        ESP_WML_LOGINFO(F("failed"));
+
+        // Trying open redundant config file
+        file = FileFS.open(CREDENTIALS_FILENAME_BACKUP, "r");
+        ESP_WML_LOGINFO(F("LoadBkUpCredFile "));
+
+        if (!file)
+        {
+          ESP_WML_LOGINFO(F("failed"));
+          return false;
+        }
+      }
+
+      bool readOK = (file.readBytes(buffer, len) == len);
+
+      ESP_WML_LOGINFO(readOK ? F("OK") : F("failed"));
+      file.close();
+
+      return readOK;
     }
 
     //////////////////////////////////////////////
 
-    void loadAndSaveDefaultConfigData()
+    bool checkDynamicData()
     {
-      // Load Default Config Data from Sketch
-      memcpy(&ESP_WM_LITE_config, &defaultConfig, sizeof(ESP_WM_LITE_config));
-      strcpy(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE);
+      const uint16_t len = dynamicDataSize();
 
-      // Including config and dynamic data, and assume valid
-      saveConfigData();
+      // Staging buffer, not to destroy myMenuItems[i].pdata with invalid data
+      char* readBuffer = new char[len];
 
-      ESP_WML_LOGERROR(F("======= Start Loaded Config Data ======="));
-      displayConfigData(ESP_WM_LITE_config);
+      if (readBuffer == NULL)
+      {
+        ESP_WML_LOGERROR(F("ChkCrR: Error can't allocate buffer."));
+        return false;
+      }
+
+      bool valid = readDynamicDataFile(readBuffer, len) && isDynamicDataValid(readBuffer);
+
+      delete [] readBuffer;
+
+      return valid;
     }
 
     //////////////////////////////////////////////
 
-    // Return false if init new EEPROM or SPIFFS. No more need trying to connect. Go directly to config mode
-    bool getConfigData()
+    bool loadDynamicData()
     {
-      bool dynamicDataValid = true;
-      int calChecksum;
-
-      hadConfigData = false;
+      if (hadDynamicData)
+      {
+        return true;
+      }
 
-#if ESP8266
+#if USING_AB_RECORD_STORAGE
 
-      // Format SPIFFS if not yet
-      if (!FileFS.begin())
+      if (loadRecord(false, true))
       {
-        FileFS.format();
-#else
+        return true;
+      }
 
-      // Format SPIFFS if not yet
-      if (!FileFS.begin(true))
-      {
-        ESP_WML_LOGERROR(F("SPIFFS/LittleFS failed! Formatting."));
 #endif
 
-        if (!FileFS.begin())
-        {
-#if USE_LITTLEFS
-          ESP_WML_LOGERROR(F("LittleFS failed!. Please use SPIFFS or EEPROM."));
-#else
-          ESP_WML_LOGERROR(F("SPIFFS failed!. Please use LittleFS or EEPROM."));
-#endif
-          return false;
-        }
+      const uint16_t len = dynamicDataSize();
+
+      totalDataSize = sizeof(ESP_WM_LITE_config) + len;
+
+      // Read and verified as a whole, then copied to each pdata only if valid
+      char* readBuffer = new char[len];
+
+      if (readBuffer == NULL)
+      {
+        ESP_WML_LOGERROR(F("CrR: Error can't allocate buffer."));
+        return false;
       }
 
-      if (LOAD_DEFAULT_CONFIG_DATA)
+      bool valid = readDynamicDataFile(readBuffer, len) && isDynamicDataValid(readBuffer);
+
+      if (valid)
       {
-        // Load Config Data from Sketch
-        memcpy(&ESP_WM_LITE_config, &defaultConfig, sizeof(ESP_WM_LITE_config));
-        strcpy(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE);
+        scatterDynamicData(readBuffer);
+      }
 
-        // Including config and dynamic data, and assume valid
-        saveAllConfigData();
+      delete [] readBuffer;
 
-        ESP_WML_LOGINFO(F("======= Start Loaded Config Data ======="));
-        displayConfigData(ESP_WM_LITE_config);
-
-        // Don't need Config Portal anymore
-        return true;
+      if (!valid)
+      {
+        return false;
       }
 
-#if USE_DYNAMIC_PARAMETERS
-      else if ( ( FileFS.exists(CONFIG_FILENAME)      || FileFS.exists(CONFIG_FILENAME_BACKUP) ) &&
-                ( FileFS.exists(CREDENTIALS_FILENAME) || FileFS.exists(CREDENTIALS_FILENAME_BACKUP) ) )
-#else
-      else if ( FileFS.exists(CONFIG_FILENAME) || FileFS.exists(CONFIG_FILENAME_BACKUP) )
-#endif
-      {
-        // Load stored config data from LittleFS
-        // Get config data. If "blank" or NULL, set false flag and exit
-        if (!loadConfigData())
-        {
-          return false;
-        }
+      hadDynamicData = true;
+      return true;
+    }
 
-        ESP_WML_LOGINFO(F("======= Start Stored Config Data ======="));
-        displayConfigData(ESP_WM_LITE_config);
+    //////////////////////////////////////////////
 
-        calChecksum = calcChecksum();
+#if USING_WRITE_AVOIDANCE
 
-        ESP_WML_LOGINFO3(F("CCSum=0x"), String(calChecksum, HEX),
-                         F(",RCSum=0x"), String(ESP_WM_LITE_config.checkSum, HEX));
+    bool isDynamicFileUnchanged(const char* filename, const int& checkSum)
+    {
+      File file = FileFS.open(filename, "r");
 
-#if USE_DYNAMIC_PARAMETERS
-        // Load dynamic data
-        dynamicDataValid = loadDynamicData();
+      if (!file)
+        return false;
 
-        if (dynamicDataValid)
-        {
-          ESP_WML_LOGINFO(F("Valid Stored Dynamic Data"));
-        }
-        else
-        {
-          ESP_WML_LOGINFO(F("Invalid Stored Dynamic Data. Ignored"));
-        }
+      size_t len = sizeof(checkSum);
 
-#endif
-      }
-      else
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
       {
-        // Not loading Default config data, but having no config file => Config Portal
-        return false;
+        len += myMenuItems[i].maxlen;
       }
 
-      if ( (strncmp(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE, strlen(ESP_WM_LITE_BOARD_TYPE)) != 0) ||
-           (calChecksum != ESP_WM_LITE_config.checkSum) || !dynamicDataValid )
+      bool unchanged = (file.size() == len);
 
+      for (uint16_t i = 0; unchanged && (i < NUM_MENU_ITEMS); i++)
       {
-        // Including Credentials CSum
-        ESP_WML_LOGINFO1(F("InitCfgFile,sz="), sizeof(ESP_WM_LITE_config));
+        unchanged = fileMatches(file, myMenuItems[i].pdata, myMenuItems[i].maxlen);
+      }
 
-        // doesn't have any configuration
-        if (LOAD_DEFAULT_CONFIG_DATA)
-        {
-          memcpy(&ESP_WM_LITE_config, &defaultConfig, sizeof(ESP_WM_LITE_config));
-        }
-        else
-        {
-          memset(&ESP_WM_LITE_config, 0, sizeof(ESP_WM_LITE_config));
+      unchanged = unchanged && fileMatches(file, &checkSum, sizeof(checkSum));
 
-          strcpy(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid,   WM_NO_CONFIG);
-          strcpy(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw,     WM_NO_CONFIG);
-          strcpy(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid,   WM_NO_CONFIG);
-          strcpy(ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw,     WM_NO_CONFIG);
-          strcpy(ESP_WM_LITE_config.board_name, WM_NO_CONFIG);
+      file.close();
 
-#if USE_DYNAMIC_PARAMETERS
+      return unchanged;
+    }
 
-          for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
-          {
-            // Actual size of pdata is [maxlen + 1]
-            memset(myMenuItems[i].pdata, 0, myMenuItems[i].maxlen + 1);
-            strncpy(myMenuItems[i].pdata, WM_NO_CONFIG, myMenuItems[i].maxlen);
-          }
+    //////////////////////////////////////////////
 
 #endif
-        }
 
-        strcpy(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE);
+    void saveDynamicData()
+    {
+#if USING_AB_RECORD_STORAGE
+      // With the Config Data and CP flag
+      saveRecord();
+#else
 
-#if USE_DYNAMIC_PARAMETERS
+      // Checksum first, to compare the files before writing them
+      int checkSum = calcMenuItemsChecksum();
 
-        for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
-        {
-          ESP_WML_LOGDEBUG3(F("g:myMenuItems["), i, F("]="), myMenuItems[i].pdata );
-        }
+      ESP_WML_LOGINFO1(F("CrWCSum=0x"), String(checkSum, HEX));
 
+#if USING_WRITE_AVOIDANCE
+      if (needsStorageWrite(isDynamicFileUnchanged(CREDENTIALS_FILENAME, checkSum)))
 #endif
+      {
+        File file = FileFS.open(CREDENTIALS_FILENAME, "w");
+        ESP_WML_LOGINFO(F("SaveCredFile "));
 
-        // Don't need
-        ESP_WM_LITE_config.checkSum = 0;
+        if (file)
+        {
+          for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+          {
+            ESP_WML_LOGDEBUG3(F("CW1:pdata="), myMenuItems[i].pdata, F(",len="), myMenuItems[i].maxlen);
 
-        saveAllConfigData();
+            file.write((uint8_t*) myMenuItems[i].pdata, myMenuItems[i].maxlen);
+          }
 
-        return false;
-      }
-      else if ( !isWiFiConfigValid() )
-      {
-        // If SSID, PW ="blank" or NULL, stay in config mode forever until having config Data.
-        return false;
+          file.write((uint8_t*) &checkSum, sizeof(checkSum));
+          file.close();
+          ESP_WML_LOGINFO(F("OK"));
+        }
+        else
+        {
+          ESP_WML_LOGINFO(F("failed"));
+        }
       }
-      else
+
+#if USING_WRITE_AVOIDANCE
+      if (needsStorageWrite(isDynamicFileUnchanged(CREDENTIALS_FILENAME_BACKUP, checkSum)))
+#endif
       {
-        displayConfigData(ESP_WM_LITE_config);
+        // Trying open redundant Auth file
+        File file = FileFS.open(CREDENTIALS_FILENAME_BACKUP, "w");
+        ESP_WML_LOGINFO(F("SaveBkUpCredFile "));
+
+        if (file)
+        {
+          for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+          {
+            ESP_WML_LOGDEBUG3(F("CW2:pdata="), myMenuItems[i].pdata, F(",len="), myMenuItems[i].maxlen);
+
+            file.write((uint8_t*) myMenuItems[i].pdata, myMenuItems[i].maxlen);
+          }
+
+          file.write((uint8_t*) &checkSum, sizeof(checkSum));
+          file.close();
+          ESP_WML_LOGINFO(F("OK"));
+        }
+        else
+        {
+          ESP_WML_LOGINFO(F("failed"));
+        }
       }
 
-      return true;
+#endif
     }
+#endif
 
     //////////////////////////////////////////////
 
-#else   // #if ( USE_LITTLEFS || USE_SPIFFS )
-
-  #ifndef EEPROM_SIZE
-    #define EEPROM_SIZE     2048
-  #else
-    #if (EEPROM_SIZE > 2048)
-      #warning EEPROM_SIZE must be <= 2048. Reset to 2048
-      #undef EEPROM_SIZE
-      #define EEPROM_SIZE     2048
-    #elif (EEPROM_SIZE < 2048)
-      #warning Preset EEPROM_SIZE <= 2048. Reset to 2048
-      #undef EEPROM_SIZE
-      #define EEPROM_SIZE     2048
-    #endif
-      // FLAG_DATA_SIZE is 4, to store DRD/MRD flag
-    #if (EEPROM_SIZE < FLAG_DATA_SIZE + CONFIG_DATA_SIZE)
-      #warning EEPROM_SIZE must be > CONFIG_DATA_SIZE. Reset to 512
-      #undef EEPROM_SIZE
-      #define EEPROM_SIZE     2048
-    #endif
-  #endif
+#if USING_AB_RECORD_STORAGE
 
-  #ifndef EEPROM_START
-    #define EEPROM_START     0      //define 256 in DRD/MRD
-  #else
-    #if (EEPROM_START + FLAG_DATA_SIZE + CONFIG_DATA_SIZE + FORCED_CONFIG_PORTAL_FLAG_DATA_SIZE > EEPROM_SIZE)
-      #error EPROM_START + FLAG_DATA_SIZE + CONFIG_DATA_SIZE + FORCED_CONFIG_PORTAL_FLAG_DATA_SIZE > EEPROM_SIZE. Please adjust.
-    #endif
-  #endif
+  #define  CONFIG_RECORD_FILENAME_A         ("/wm_rec_a.dat")
+  #define  CONFIG_RECORD_FILENAME_B         ("/wm_rec_b.dat")
 
-  // Stating positon to store ESP_WM_LITE_config
-  #define CONFIG_EEPROM_START    (EEPROM_START + FLAG_DATA_SIZE)
+    const char* recordFilename(const uint8_t& slot)
+    {
+      return slot ? CONFIG_RECORD_FILENAME_B : CONFIG_RECORD_FILENAME_A;
+    }
 
     //////////////////////////////////////////////
 
-    void setForcedCP(const bool& isPersistent)
+    uint32_t recordPayloadSize()
     {
-      uint32_t readForcedConfigPortalFlag = isPersistent ? FORCED_PERS_CONFIG_PORTAL_FLAG_DATA :
-                                            FORCED_CONFIG_PORTAL_FLAG_DATA;
+      uint32_t len = sizeof(ESP_WM_LITE_config) + sizeof(_recordCPFlag);
 
-      ESP_WML_LOGINFO(F("setForcedCP"));
+#if USE_DYNAMIC_PARAMETERS
+      len += dynamicDataSize();
+#endif
 
-      EEPROM.put(CONFIG_EEPROM_START + CONFIG_DATA_SIZE, readForcedConfigPortalFlag);
-      EEPROM.commit();
+      return len;
     }
-    
+
     //////////////////////////////////////////////
 
-    void clearForcedCP()
+    // CRC32 of the header, without its crc, then of the payload following it in record
+    uint32_t calcRecordCRC(const char* record)
     {
-      ESP_WML_LOGINFO(F("clearForcedCP"));
+      const ESP_WM_LITE_Record_Header* header = (const ESP_WM_LITE_Record_Header*) record;
 
-      EEPROM.put(CONFIG_EEPROM_START + CONFIG_DATA_SIZE, 0);
-      EEPROM.commit();
+      uint32_t crc = calcCRC32(0, record, offsetof(ESP_WM_LITE_Record_Header, crc));
+
+      return calcCRC32(crc, record + sizeof(ESP_WM_LITE_Record_Header), header->length);
     }
 
     //////////////////////////////////////////////
 
-    bool isForcedCP()
+    // Read the headers of both slots, then the payload of the newest valid one, or of the other one if its CRC fails.
+    // Staged in record, of sizeof(ESP_WM_LITE_Record_Header) + recordPayloadSize()
+    bool readRecord(char* record)
     {
-      uint32_t readForcedConfigPortalFlag;
-
-      ESP_WML_LOGINFO(F("Check if isForcedCP"));
-
-      // Return true if forced CP (0xDEADBEEF read at offset EPROM_START + DRD_FLAG_DATA_SIZE + CONFIG_DATA_SIZE)
-      // => set flag noForcedConfigPortal = false
-      EEPROM.get(CONFIG_EEPROM_START + CONFIG_DATA_SIZE, readForcedConfigPortalFlag);
+      const uint32_t payloadSize = recordPayloadSize();
+      ESP_WM_LITE_Record_Header headers[2];
+      File files[2];
+      bool valid[2];
+      bool loaded = false;
 
-      // Return true if forced CP (0xDEADBEEF read at offset EPROM_START + DRD_FLAG_DATA_SIZE + CONFIG_DATA_SIZE)
-      // => set flag noForcedConfigPortal = false
-      if (readForcedConfigPortalFlag == FORCED_CONFIG_PORTAL_FLAG_DATA)
-      {
-        persForcedConfigPortal = false;
-        return true;
-      }
-      else if (readForcedConfigPortalFlag == FORCED_PERS_CONFIG_PORTAL_FLAG_DATA)
+      for (uint8_t slot = 0; slot < 2; slot++)
       {
-        persForcedConfigPortal = true;
-        return true;
+        files[slot] = FileFS.open(recordFilename(slot), "r");
+
+        valid[slot] = files[slot] &&
+                      (files[slot].read((uint8_t*) &headers[slot], sizeof(headers[slot])) == sizeof(headers[slot])) &&
+                      (headers[slot].magic == ESP_WM_LITE_RECORD_MAGIC) && (headers[slot].length == payloadSize);
       }
-      else
+
+      // Newest first. Sequence numbers compared to also work after wrapping around
+      uint8_t slot = ( valid[1] && ( !valid[0] || ( (int32_t) (headers[1].sequence - headers[0].sequence) > 0 ) ) ) ? 1 : 0;
+
+      for (uint8_t i = 0; (i < 2) && !loaded; i++, slot ^= 1)
       {
-        return false;
+        if (!valid[slot])
+          continue;
+
+        memcpy(record, &headers[slot], sizeof(headers[slot]));
+
+        loaded = (files[slot].read((uint8_t*) record + sizeof(headers[slot]), payloadSize) == payloadSize) &&
+                 (calcRecordCRC(record) == headers[slot].crc);
+
+        if (loaded)
+        {
+          _recordSlot     = slot;
+          _recordSequence = headers[slot].sequence;
+        }
+        else
+        {
+          ESP_WML_LOGERROR1(F("Invalid record:"), recordFilename(slot));
+        }
       }
+
+      files[0].close();
+      files[1].close();
+
+      return loaded;
     }
 
     //////////////////////////////////////////////
 
-#if USE_DYNAMIC_PARAMETERS
-
-    bool checkDynamicData()
+    // Forced CP flag, and Config Data and/or dynamic data if asked, from the newest valid record
+    bool loadRecord(const bool& loadConfig, const bool& loadDynamic)
     {
-      int checkSum = 0;
-      int readCheckSum;
+      char* record = new char[sizeof(ESP_WM_LITE_Record_Header) + recordPayloadSize()];
 
-#define BUFFER_LEN      128
-      char readBuffer[BUFFER_LEN + 1];
+      if (record == NULL)
+      {
+        ESP_WML_LOGERROR(F("LoadRecord: Error can't allocate buffer."));
+        return false;
+      }
 
-      uint16_t offset = CONFIG_EEPROM_START + sizeof(ESP_WM_LITE_config) + FORCED_CONFIG_PORTAL_FLAG_DATA_SIZE;
+      ESP_WML_LOGINFO(F("LoadRecord "));
 
-      // Find the longest pdata, then dynamically allocate buffer. Remember to free when done
-      // This is used to store tempo data to calculate checksum to see of data is valid
-      // We dont like to destroy myMenuItems[i].pdata with invalid data
+      bool loaded = readRecord(record);
 
-      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      if (loaded)
       {
-        if (myMenuItems[i].maxlen > BUFFER_LEN)
-        {
-          // Size too large, abort and flag false
-          ESP_WML_LOGERROR(F("ChkCrR: Error Small Buffer."));
-          return false;
-        }
-      }
+        const char* _pointer = record + sizeof(ESP_WM_LITE_Record_Header);
 
-      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
-      {
-        char* _pointer = readBuffer;
+        if (loadConfig)
+          memcpy(&ESP_WM_LITE_config, _pointer, sizeof(ESP_WM_LITE_config));
 
-        // Prepare buffer, more than enough
-        memset(readBuffer, 0, sizeof(readBuffer));
+        _pointer += sizeof(ESP_WM_LITE_config);
 
-        // Read more than necessary, but OK and easier to code
-        EEPROM.get(offset, readBuffer);
-        // NULL terminated
-        readBuffer[myMenuItems[i].maxlen] = 0;
+        memcpy(&_recordCPFlag, _pointer, sizeof(_recordCPFlag));
+        _pointer += sizeof(_recordCPFlag);
 
-        ESP_WML_LOGDEBUG3(F("ChkCrR:pdata="), readBuffer, F(",len="), myMenuItems[i].maxlen);
+#if USE_DYNAMIC_PARAMETERS
 
-        for (uint16_t j = 0; j < myMenuItems[i].maxlen; j++, _pointer++)
+        // Already checked by the CRC32 of the record
+        if (loadDynamic)
         {
-          checkSum += *_pointer;
+          scatterDynamicData(_pointer);
+          hadDynamicData = true;
         }
 
-        offset += myMenuItems[i].maxlen;
-      }
-
-      EEPROM.get(offset, readCheckSum);
+#else
+        (void) loadDynamic;
+#endif
 
-      ESP_WML_LOGINFO3(F("ChkCrR:CrCCsum=0x"), String(checkSum, HEX), F(",CrRCsum=0x"), String(readCheckSum, HEX));
+        _hasRecord = true;
 
-      if ( checkSum != readCheckSum)
+        ESP_WML_LOGINFO3(F("OK, slot="), _recordSlot, F(",seq="), _recordSequence);
+      }
+      else
       {
-        return false;
+        ESP_WML_LOGINFO(F("failed"));
       }
 
-      return true;
+      delete [] record;
+
+      return loaded;
     }
 
     //////////////////////////////////////////////
 
-    bool EEPROM_getDynamicData()
+    // One write of the Config Data, forced CP flag and dynamic data in RAM, to the slot not holding the newest record
+    void saveRecord()
     {
-      int readCheckSum;
-      int checkSum = 0;
-      uint16_t offset = CONFIG_EEPROM_START + sizeof(ESP_WM_LITE_config) + FORCED_CONFIG_PORTAL_FLAG_DATA_SIZE;
+      const uint32_t payloadSize = recordPayloadSize();
+      const uint32_t recordSize  = sizeof(ESP_WM_LITE_Record_Header) + payloadSize;
 
-      totalDataSize = sizeof(ESP_WM_LITE_config) + sizeof(readCheckSum);
+      char* record = new char[recordSize];
 
-      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      if (record == NULL)
       {
-        char* _pointer = myMenuItems[i].pdata;
-        totalDataSize += myMenuItems[i].maxlen;
+        ESP_WML_LOGERROR(F("SaveRecord: Error can't allocate buffer."));
+        return;
+      }
 
-        // Actual size of pdata is [maxlen + 1]
-        memset(myMenuItems[i].pdata, 0, myMenuItems[i].maxlen + 1);
+      ESP_WM_LITE_Record_Header* header = (ESP_WM_LITE_Record_Header*) record;
+      char* _pointer = record + sizeof(ESP_WM_LITE_Record_Header);
 
-        for (uint16_t j = 0; j < myMenuItems[i].maxlen; j++, _pointer++, offset++)
-        {
-          *_pointer = EEPROM.read(offset);
+      memcpy(_pointer, &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config));
+      _pointer += sizeof(ESP_WM_LITE_config);
 
-          checkSum += *_pointer;
-        }
+      memcpy(_pointer, &_recordCPFlag, sizeof(_recordCPFlag));
+      _pointer += sizeof(_recordCPFlag);
 
-        ESP_WML_LOGDEBUG3(F("CR:pdata="), myMenuItems[i].pdata, F(",len="), myMenuItems[i].maxlen);
+#if USE_DYNAMIC_PARAMETERS
+
+      // As in CREDENTIALS_FILENAME
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      {
+        memcpy(_pointer, myMenuItems[i].pdata, myMenuItems[i].maxlen);
+        _pointer += myMenuItems[i].maxlen;
       }
 
-      EEPROM.get(offset, readCheckSum);
+      int checkSum = calcMenuItemsChecksum();
+      memcpy(_pointer, &checkSum, sizeof(checkSum));
 
-      ESP_WML_LOGINFO3(F("CrCCsum=0x"), String(checkSum, HEX), F(",CrRCsum=0x"), String(readCheckSum, HEX));
+#endif
+
+      header->magic  = ESP_WM_LITE_RECORD_MAGIC;
+      header->length = payloadSize;
+
+#if USING_WRITE_AVOIDANCE
+      // Same as the newest record, with its sequence number
+      header->sequence  = _recordSequence;
+      header->crc       = calcRecordCRC(record);
 
-      if ( checkSum != readCheckSum)
+      if (!needsStorageWrite(_hasRecord && isFileUnchanged(recordFilename(_recordSlot), record, recordSize)))
       {
-        return false;
+        delete [] record;
+        return;
       }
+#endif
 
-      return true;
-    }
+      const uint8_t slot = _hasRecord ? (_recordSlot ^ 1) : 0;
 
-    //////////////////////////////////////////////
+      header->sequence  = _recordSequence + 1;
+      header->crc       = calcRecordCRC(record);
 
-    void EEPROM_putDynamicData()
-    {
-      int checkSum = 0;
-      uint16_t offset = CONFIG_EEPROM_START + sizeof(ESP_WM_LITE_config) + FORCED_CONFIG_PORTAL_FLAG_DATA_SIZE;
+      File file = FileFS.open(recordFilename(slot), "w");
+      ESP_WML_LOGINFO1(F("SaveRecord,slot="), slot);
 
-      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      if (file)
       {
-        char* _pointer = myMenuItems[i].pdata;
+        bool written = (file.write((uint8_t*) record, recordSize) == recordSize);
 
-        ESP_WML_LOGDEBUG3(F("CW:pdata="), myMenuItems[i].pdata, F(",len="), myMenuItems[i].maxlen);
+        file.close();
+
+        ESP_WML_LOGINFO(written ? F("OK") : F("failed"));
 
-        for (uint16_t j = 0; j < myMenuItems[i].maxlen; j++, _pointer++, offset++)
+        if (written)
         {
-          EEPROM.write(offset, *_pointer);
+          // First record : now holds all the data of the files of previous versions
+          if (!_hasRecord)
+            removeLegacyFiles();
 
-          checkSum += *_pointer;
+          _hasRecord      = true;
+          _recordSlot     = slot;
+          _recordSequence = header->sequence;
         }
       }
+      else
+      {
+        ESP_WML_LOGINFO(F("failed"));
+      }
 
-      EEPROM.put(offset, checkSum);
-      //EEPROM.commit();
+      delete [] record;
+    }
 
-      ESP_WML_LOGINFO1(F("CrWCSum=0x"), String(checkSum, HEX));
+    //////////////////////////////////////////////
+
+    // Not to be loaded again if both record slots later fail
+    void removeLegacyFiles()
+    {
+      const char* files[] = { CONFIG_FILENAME, CONFIG_FILENAME_BACKUP, CREDENTIALS_FILENAME, CREDENTIALS_FILENAME_BACKUP,
+                              CONFIG_PORTAL_FILENAME, CONFIG_PORTAL_FILENAME_BACKUP
+                            };
+
+      for (uint8_t i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+      {
+        if (FileFS.exists(files[i]))
+        {
+          ESP_WML_LOGINFO1(F("Remove "), files[i]);
+          FileFS.remove(files[i]);
+        }
+      }
     }
+
+    //////////////////////////////////////////////
+
 #endif
 
+    void NULLTerminateConfig()
+    {
+      //#define HEADER_MAX_LEN      16
+      //#define SERVER_MAX_LEN      32
+      //#define TOKEN_MAX_LEN       36
+
+      // NULL Terminating to be sure
+      ESP_WM_LITE_config.header[HEADER_MAX_LEN - 1] = 0;
+
+      for (uint8_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
+      {
+        ESP_WM_LITE_config.WiFi_Creds[i].wifi_ssid[SSID_MAX_LEN - 1] = 0;
+        ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw  [PASS_MAX_LEN - 1] = 0;
+      }
+
+      ESP_WM_LITE_config.board_name[BOARD_NAME_MAX_LEN - 1]  = 0;
+    }
+
     //////////////////////////////////////////////
 
-    void saveConfigData()
+    bool loadConfigData()
     {
-      int calChecksum = calcChecksum();
-      ESP_WM_LITE_config.checkSum = calChecksum;
-      ESP_WML_LOGINFO3(F("SaveEEPROM,sz="), EEPROM_SIZE, F(",CSum=0x"), String(calChecksum, HEX))
+      File file = FileFS.open(CONFIG_FILENAME, "r");
+      ESP_WML_LOGINFO(F("LoadCfgFile "));
 
-      EEPROM.put(CONFIG_EEPROM_START, ESP_WM_LITE_config);
+      if (!file)
+      {
+        ESP_WML_LOGINFO(F("failed"));
 
-      EEPROM.commit();
+        // Trying open redundant config file
+        file = FileFS.open(CONFIG_FILENAME_BACKUP, "r");
+        ESP_WML_LOGINFO(F("LoadBkUpCfgFile "));
+
+        if (!file)
+        {
+          ESP_WML_LOGINFO(F("failed"));
+          return false;
+        }
+      }
+
+      file.readBytes((char *) &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config));
+
+      ESP_WML_LOGINFO(F("OK"));
+      file.close();
+
+      return isWiFiConfigValid();
     }
 
     //////////////////////////////////////////////
 
-    void saveAllConfigData()
+    void saveConfigData()
     {
+      ESP_WM_LITE_config.header[ESP_WM_LITE_FORMAT_INDEX] = ESP_WM_LITE_FORMAT;
+
       int calChecksum = calcChecksum();
       ESP_WM_LITE_config.checkSum = calChecksum;
-      ESP_WML_LOGINFO3(F("SaveEEPROM,sz="), EEPROM_SIZE, F(",CSum=0x"), String(calChecksum, HEX))
+      ESP_WML_LOGINFO1(F("WCSum=0x"), String(calChecksum, HEX));
 
-      EEPROM.put(CONFIG_EEPROM_START, ESP_WM_LITE_config);
+#if USING_AB_RECORD_STORAGE
+      // With the dynamic data and CP flag
+      saveRecord();
+#else
 
-#if USE_DYNAMIC_PARAMETERS
-      EEPROM_putDynamicData();
+#if USING_WRITE_AVOIDANCE
+      if (needsStorageWrite(isFileUnchanged(CONFIG_FILENAME, &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config))))
 #endif
+      {
+        File file = FileFS.open(CONFIG_FILENAME, "w");
+        ESP_WML_LOGINFO(F("SaveCfgFile "));
 
-      EEPROM.commit();
+        if (file)
+        {
+          file.write((uint8_t*) &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config));
+          file.close();
+          ESP_WML_LOGINFO(F("OK"));
+        }
+        else
+        {
+          ESP_WML_LOGINFO(F("failed"));
+        }
+      }
+
+#if USING_WRITE_AVOIDANCE
+      if (needsStorageWrite(isFileUnchanged(CONFIG_FILENAME_BACKUP, &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config))))
+#endif
+      {
+        // Trying open redundant Auth file
+        File file = FileFS.open(CONFIG_FILENAME_BACKUP, "w");
+        ESP_WML_LOGINFO(F("SaveBkUpCfgFile "));
+
+        if (file)
+        {
+          file.write((uint8_t *) &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config));
+          file.close();
+          ESP_WML_LOGINFO(F("OK"));
+        }
+        else
+        {
+          ESP_WML_LOGINFO(F("failed"));
+        }
+      }
+
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+    void saveAllConfigData()
+    {
+      saveConfigData();
+
+#if ( USE_DYNAMIC_PARAMETERS && !USING_AB_RECORD_STORAGE )
+      saveDynamicData();
+#endif
     }
 
     //////////////////////////////////////////////
@@ -2430,12 +3802,13 @@ class ESPAsync_WiFiManager_Lite
       // Including config and dynamic data, and assume valid
       saveConfigData();
 
-      ESP_WML_LOGINFO(F("======= Start Loaded Config Data ======="));
+      ESP_WML_LOGERROR(F("======= Start Loaded Config Data ======="));
       displayConfigData(ESP_WM_LITE_config);
     }
 
     //////////////////////////////////////////////
 
+    // Return false if init new EEPROM or SPIFFS. No more need trying to connect. Go directly to config mode
     bool getConfigData()
     {
       bool dynamicDataValid = true;
@@ -2443,8 +3816,30 @@ class ESPAsync_WiFiManager_Lite
 
       hadConfigData = false;
 
-      EEPROM.begin(EEPROM_SIZE);
-      ESP_WML_LOGINFO1(F("EEPROMsz:"), EEPROM_SIZE);
+#if ESP8266
+
+      // Format SPIFFS if not yet
+      if (!FileFS.begin())
+      {
+        FileFS.format();
+#else
+
+      // Format SPIFFS if not yet
+      if (!FileFS.begin(true))
+      {
+        ESP_WML_LOGERROR(F("SPIFFS/LittleFS failed! Formatting."));
+#endif
+
+        if (!FileFS.begin())
+        {
+#if USE_LITTLEFS
+          ESP_WML_LOGERROR(F("LittleFS failed!. Please use SPIFFS or EEPROM."));
+#else
+          ESP_WML_LOGERROR(F("SPIFFS failed!. Please use LittleFS or EEPROM."));
+#endif
+          return false;
+        }
+      }
 
       if (LOAD_DEFAULT_CONFIG_DATA)
       {
@@ -2452,6 +3847,13 @@ class ESPAsync_WiFiManager_Lite
         memcpy(&ESP_WM_LITE_config, &defaultConfig, sizeof(ESP_WM_LITE_config));
         strcpy(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE);
 
+#if USING_AB_RECORD_STORAGE
+        // Only the CP flag, slot and sequence number of the stored record, to save after it. Else from the files of
+        // previous versions
+        if (!loadRecord(false, false))
+          _recordCPFlag = readCPFile();
+#endif
+
         // Including config and dynamic data, and assume valid
         saveAllConfigData();
 
@@ -2461,14 +3863,13 @@ class ESPAsync_WiFiManager_Lite
         // Don't need Config Portal anymore
         return true;
       }
-      else
-      {
-        // Load data from EEPROM
-        EEPROM.get(CONFIG_EEPROM_START, ESP_WM_LITE_config);
 
-        if ( !isWiFiConfigValid() )
+#if USING_AB_RECORD_STORAGE
+      else if (loadRecord(true, true))
+      {
+        // Config Data, CP flag and dynamic data, all checked by the CRC32 of the record
+        if (!isWiFiConfigValid())
         {
-          // If SSID, PW ="blank" or NULL, stay in config mode forever until having config Data.
           return false;
         }
 
@@ -2479,11 +3880,39 @@ class ESPAsync_WiFiManager_Lite
 
         ESP_WML_LOGINFO3(F("CCSum=0x"), String(calChecksum, HEX),
                          F(",RCSum=0x"), String(ESP_WM_LITE_config.checkSum, HEX));
+      }
+#endif
 
 #if USE_DYNAMIC_PARAMETERS
+      else if ( ( FileFS.exists(CONFIG_FILENAME)      || FileFS.exists(CONFIG_FILENAME_BACKUP) ) &&
+                ( FileFS.exists(CREDENTIALS_FILENAME) || FileFS.exists(CREDENTIALS_FILENAME_BACKUP) ) )
+#else
+      else if ( FileFS.exists(CONFIG_FILENAME) || FileFS.exists(CONFIG_FILENAME_BACKUP) )
+#endif
+      {
+#if USING_AB_RECORD_STORAGE
+        // Kept by the first record written
+        _recordCPFlag = readCPFile();
+#endif
 
-        // Load dynamic data from EEPROM
-        dynamicDataValid = EEPROM_getDynamicData();
+        // Load stored config data from LittleFS
+        // Get config data. If "blank" or NULL, set false flag and exit
+        if (!loadConfigData())
+        {
+          return false;
+        }
+
+        ESP_WML_LOGINFO(F("======= Start Stored Config Data ======="));
+        displayConfigData(ESP_WM_LITE_config);
+
+        calChecksum = calcChecksum();
+
+        ESP_WML_LOGINFO3(F("CCSum=0x"), String(calChecksum, HEX),
+                         F(",RCSum=0x"), String(ESP_WM_LITE_config.checkSum, HEX));
+
+#if USE_DYNAMIC_PARAMETERS
+        // Load dynamic data
+        dynamicDataValid = loadDynamicData();
 
         if (dynamicDataValid)
         {
@@ -2496,12 +3925,18 @@ class ESPAsync_WiFiManager_Lite
 
 #endif
       }
+      else
+      {
+        // Not loading Default config data, but having no config file => Config Portal
+        return false;
+      }
 
       if ( (strncmp(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE, strlen(ESP_WM_LITE_BOARD_TYPE)) != 0) ||
            (calChecksum != ESP_WM_LITE_config.checkSum) || !dynamicDataValid )
+
       {
         // Including Credentials CSum
-        ESP_WML_LOGINFO3(F("InitEEPROM,sz="), EEPROM_SIZE, F(",DataSz="), totalDataSize);
+        ESP_WML_LOGINFO1(F("InitCfgFile,sz="), sizeof(ESP_WM_LITE_config));
 
         // doesn't have any configuration
         if (LOAD_DEFAULT_CONFIG_DATA)
@@ -2512,10 +3947,12 @@ class ESPAsync_WiFiManager_Lite
         {
           memset(&ESP_WM_LITE_config, 0, sizeof(ESP_WM_LITE_config));
 
-          strcpy(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid,   WM_NO_CONFIG);
-          strcpy(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw,     WM_NO_CONFIG);
-          strcpy(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid,   WM_NO_CONFIG);
-          strcpy(ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw,     WM_NO_CONFIG);
+          for (uint8_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
+          {
+            strcpy(ESP_WM_LITE_config.WiFi_Creds[i].wifi_ssid,   WM_NO_CONFIG);
+            strcpy(ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw,     WM_NO_CONFIG);
+          }
+
           strcpy(ESP_WM_LITE_config.board_name, WM_NO_CONFIG);
 
 #if USE_DYNAMIC_PARAMETERS
@@ -2561,466 +3998,3730 @@ class ESPAsync_WiFiManager_Lite
       return true;
     }
 
-#endif    // #if ( USE_LITTLEFS || USE_SPIFFS )
-
     //////////////////////////////////////////////
 
-    // New connectMultiWiFi() logic from v1.7.0
-    // Max times to try WiFi per loop() iteration. To avoid blocking issue in loop()
-    // Default 1 and minimum 1.
-#if !defined(MAX_NUM_WIFI_RECON_TRIES_PER_LOOP)
-#define MAX_NUM_WIFI_RECON_TRIES_PER_LOOP     1
-#else
-#if (MAX_NUM_WIFI_RECON_TRIES_PER_LOOP < 1)
-#define MAX_NUM_WIFI_RECON_TRIES_PER_LOOP     1
-#endif
-#endif
+#else   // #if ( USE_LITTLEFS || USE_SPIFFS )
 
-    uint8_t connectMultiWiFi()
-    {
-#if ESP32
-      // For ESP32, this better be 0 to shorten the connect time.
-      // For ESP32-S2/C3, must be > 500
-#if ( USING_ESP32_S2 || USING_ESP32_C3 )
-#define WIFI_MULTI_1ST_CONNECT_WAITING_MS           500L
-#else
-      // For ESP32 core v1.0.6, must be >= 500
-#define WIFI_MULTI_1ST_CONNECT_WAITING_MS           800L
-#endif
-#else
-      // For ESP8266, this better be 2200 to enable connect the 1st time
-#define WIFI_MULTI_1ST_CONNECT_WAITING_MS             2200L
-#endif
+  #ifndef EEPROM_SIZE
+    #define EEPROM_SIZE     2048
+  #else
+    #if (EEPROM_SIZE > 2048)
+      #warning EEPROM_SIZE must be <= 2048. Reset to 2048
+      #undef EEPROM_SIZE
+      #define EEPROM_SIZE     2048
+    #elif (EEPROM_SIZE < 2048)
+      #warning Preset EEPROM_SIZE <= 2048. Reset to 2048
+      #undef EEPROM_SIZE
+      #define EEPROM_SIZE     2048
+    #endif
+      // FLAG_DATA_SIZE is 4, to store DRD/MRD flag
+    #if (EEPROM_SIZE < FLAG_DATA_SIZE + CONFIG_DATA_SIZE)
+      #warning EEPROM_SIZE must be > CONFIG_DATA_SIZE. Reset to 512
+      #undef EEPROM_SIZE
+      #define EEPROM_SIZE     2048
+    #endif
+  #endif
 
-#define WIFI_MULTI_CONNECT_WAITING_MS                   500L
+  #ifndef EEPROM_START
+    #define EEPROM_START     0      //define 256 in DRD/MRD
+  #else
+    #if (EEPROM_START + FLAG_DATA_SIZE + CONFIG_DATA_SIZE + FORCED_CONFIG_PORTAL_FLAG_DATA_SIZE > EEPROM_SIZE)
+      #error EPROM_START + FLAG_DATA_SIZE + CONFIG_DATA_SIZE + FORCED_CONFIG_PORTAL_FLAG_DATA_SIZE > EEPROM_SIZE. Please adjust.
+    #endif
+  #endif
 
-      uint8_t status;
+  // Stating positon to store ESP_WM_LITE_config
+  #define CONFIG_EEPROM_START    (EEPROM_START + FLAG_DATA_SIZE)
 
-      ESP_WML_LOGINFO(F("Connecting MultiWifi..."));
+    //////////////////////////////////////////////
 
-      WiFi.mode(WIFI_STA);
+#if USING_WRITE_AVOIDANCE
 
-      setHostname();
+    // Compared with the RAM copy of the EEPROM, only EEPROM.commit() writes the flash
+    bool isEEPROMUnchanged(const uint16_t& offset, const void* data, const uint16_t& len)
+    {
+#if ESP8266
+      return (memcmp(EEPROM.getConstDataPtr() + offset, data, len) == 0);
+#else
+      // No const access on ESP32 : getDataPtr() would make the next commit() write. Compared by chunks
+      uint8_t buffer[32];
+      const uint16_t chunk = sizeof(buffer);
 
-      int i = 0;
-      status = wifiMulti.run();
-      delay(WIFI_MULTI_1ST_CONNECT_WAITING_MS);
+      for (uint16_t done = 0; done < len; done += chunk)
+      {
+        const uint16_t size = (len - done < chunk) ? (len - done) : chunk;
+
+        EEPROM.readBytes(offset + done, buffer, size);
+
+        if (memcmp(buffer, (const uint8_t*) data + done, size) != 0)
+          return false;
+      }
+
+      return true;
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+    void setForcedCP(const bool& isPersistent)
+    {
+      uint32_t readForcedConfigPortalFlag = isPersistent ? FORCED_PERS_CONFIG_PORTAL_FLAG_DATA :
+                                            FORCED_CONFIG_PORTAL_FLAG_DATA;
+
+      ESP_WML_LOGINFO(F("setForcedCP"));
+
+#if USING_WRITE_AVOIDANCE
+      if (!needsStorageWrite(isEEPROMUnchanged(CONFIG_EEPROM_START + CONFIG_DATA_SIZE, &readForcedConfigPortalFlag,
+                                               sizeof(readForcedConfigPortalFlag))))
+        return;
+#endif
+
+      EEPROM.put(CONFIG_EEPROM_START + CONFIG_DATA_SIZE, readForcedConfigPortalFlag);
+      EEPROM.commit();
+    }
+    
+    //////////////////////////////////////////////
+
+    void clearForcedCP()
+    {
+      ESP_WML_LOGINFO(F("clearForcedCP"));
+
+#if USING_WRITE_AVOIDANCE
+      const uint32_t readForcedConfigPortalFlag = 0;
+
+      if (!needsStorageWrite(isEEPROMUnchanged(CONFIG_EEPROM_START + CONFIG_DATA_SIZE, &readForcedConfigPortalFlag,
+                                               sizeof(readForcedConfigPortalFlag))))
+        return;
+#endif
+
+      EEPROM.put(CONFIG_EEPROM_START + CONFIG_DATA_SIZE, 0);
+      EEPROM.commit();
+    }
+
+    //////////////////////////////////////////////
+
+    bool isForcedCP()
+    {
+      uint32_t readForcedConfigPortalFlag;
+
+      ESP_WML_LOGINFO(F("Check if isForcedCP"));
+
+      // Return true if forced CP (0xDEADBEEF read at offset EPROM_START + DRD_FLAG_DATA_SIZE + CONFIG_DATA_SIZE)
+      // => set flag noForcedConfigPortal = false
+      EEPROM.get(CONFIG_EEPROM_START + CONFIG_DATA_SIZE, readForcedConfigPortalFlag);
+
+      // Return true if forced CP (0xDEADBEEF read at offset EPROM_START + DRD_FLAG_DATA_SIZE + CONFIG_DATA_SIZE)
+      // => set flag noForcedConfigPortal = false
+      if (readForcedConfigPortalFlag == FORCED_CONFIG_PORTAL_FLAG_DATA)
+      {
+        persForcedConfigPortal = false;
+        return true;
+      }
+      else if (readForcedConfigPortalFlag == FORCED_PERS_CONFIG_PORTAL_FLAG_DATA)
+      {
+        persForcedConfigPortal = true;
+        return true;
+      }
+      else
+      {
+        return false;
+      }
+    }
+
+    //////////////////////////////////////////////
+
+#if USE_DYNAMIC_PARAMETERS
+
+    uint16_t EEPROM_dynamicDataOffset()
+    {
+      return CONFIG_EEPROM_START + sizeof(ESP_WM_LITE_config) + FORCED_CONFIG_PORTAL_FLAG_DATA_SIZE;
+    }
+
+    //////////////////////////////////////////////
+
+    bool EEPROM_isDynamicDataInSize()
+    {
+      if (EEPROM_dynamicDataOffset() + dynamicDataSize() > EEPROM_SIZE)
+      {
+        ESP_WML_LOGERROR(F("CR: Error dynamic data > EEPROM_SIZE"));
+        return false;
+      }
+
+      return true;
+    }
+
+    //////////////////////////////////////////////
+
+    // The stored dynamic data. On ESP8266 in place in the RAM copy of the EEPROM. ESP32 has no const access to it,
+    // getDataPtr() would make the next commit() write, so it's read into a buffer.
+    // NULL if it doesn't fit in EEPROM_SIZE. To release by EEPROM_freeDynamicData()
+    const char* EEPROM_readDynamicData()
+    {
+      if (!EEPROM_isDynamicDataInSize())
+        return NULL;
+
+#if ESP8266
+      return (const char*) EEPROM.getConstDataPtr() + EEPROM_dynamicDataOffset();
+#else
+      char* readBuffer = new char[dynamicDataSize()];
+
+      if (readBuffer == NULL)
+      {
+        ESP_WML_LOGERROR(F("CR: Error can't allocate buffer."));
+        return NULL;
+      }
+
+      EEPROM.readBytes(EEPROM_dynamicDataOffset(), readBuffer, dynamicDataSize());
+
+      return readBuffer;
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+    void EEPROM_freeDynamicData(const char* storedData)
+    {
+#if ESP8266
+      (void) storedData;
+#else
+      delete [] storedData;
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+    bool checkDynamicData()
+    {
+      const char* storedData = EEPROM_readDynamicData();
+
+      bool valid = storedData && isDynamicDataValid(storedData);
+
+      EEPROM_freeDynamicData(storedData);
+
+      return valid;
+    }
+
+    //////////////////////////////////////////////
+
+    bool EEPROM_getDynamicData()
+    {
+      const char* storedData = EEPROM_readDynamicData();
+
+      totalDataSize = sizeof(ESP_WM_LITE_config) + dynamicDataSize();
+
+      // Copied to each pdata only if valid
+      bool valid = storedData && isDynamicDataValid(storedData);
+
+      if (valid)
+      {
+        scatterDynamicData(storedData);
+      }
+
+      EEPROM_freeDynamicData(storedData);
+
+      return valid;
+    }
+
+    //////////////////////////////////////////////
+
+#if USING_WRITE_AVOIDANCE
+
+    bool EEPROM_isDynamicDataUnchanged()
+    {
+      const char* storedData = EEPROM_readDynamicData();
+      const char* _pointer   = storedData;
+
+      if (!storedData)
+        return false;
+
+      bool unchanged = true;
+
+      for (uint16_t i = 0; unchanged && (i < NUM_MENU_ITEMS); i++)
+      {
+        unchanged = (memcmp(_pointer, myMenuItems[i].pdata, myMenuItems[i].maxlen) == 0);
+
+        _pointer += myMenuItems[i].maxlen;
+      }
+
+      if (unchanged)
+      {
+        int readCheckSum;
+
+        memcpy(&readCheckSum, _pointer, sizeof(readCheckSum));
+
+        // Same checksum as written now, not only valid
+        unchanged = (readCheckSum == calcDynamicChecksum(storedData, _pointer - storedData));
+      }
+
+      EEPROM_freeDynamicData(storedData);
+
+      return unchanged;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+    void EEPROM_putDynamicData()
+    {
+      if (!EEPROM_isDynamicDataInSize())
+        return;
+
+      // Marks the data to write by next commit()
+      char* storedData = (char*) EEPROM.getDataPtr() + EEPROM_dynamicDataOffset();
+      char* _pointer   = storedData;
+
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      {
+        ESP_WML_LOGDEBUG3(F("CW:pdata="), myMenuItems[i].pdata, F(",len="), myMenuItems[i].maxlen);
+
+        memcpy(_pointer, myMenuItems[i].pdata, myMenuItems[i].maxlen);
+        _pointer += myMenuItems[i].maxlen;
+      }
+
+      int checkSum = calcDynamicChecksum(storedData, _pointer - storedData);
+
+      memcpy(_pointer, &checkSum, sizeof(checkSum));
+      //EEPROM.commit();
+
+      ESP_WML_LOGINFO1(F("CrWCSum=0x"), String(checkSum, HEX));
+    }
+#endif
+
+    //////////////////////////////////////////////
+
+    void saveConfigData()
+    {
+      ESP_WM_LITE_config.header[ESP_WM_LITE_FORMAT_INDEX] = ESP_WM_LITE_FORMAT;
+
+      int calChecksum = calcChecksum();
+      ESP_WM_LITE_config.checkSum = calChecksum;
+      ESP_WML_LOGINFO3(F("SaveEEPROM,sz="), EEPROM_SIZE, F(",CSum=0x"), String(calChecksum, HEX))
+
+#if USING_WRITE_AVOIDANCE
+      if (!needsStorageWrite(isEEPROMUnchanged(CONFIG_EEPROM_START, &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config))))
+        return;
+#endif
+
+      EEPROM.put(CONFIG_EEPROM_START, ESP_WM_LITE_config);
+
+      EEPROM.commit();
+    }
+
+    //////////////////////////////////////////////
+
+    void saveAllConfigData()
+    {
+      ESP_WM_LITE_config.header[ESP_WM_LITE_FORMAT_INDEX] = ESP_WM_LITE_FORMAT;
+
+      int calChecksum = calcChecksum();
+      ESP_WM_LITE_config.checkSum = calChecksum;
+      ESP_WML_LOGINFO3(F("SaveEEPROM,sz="), EEPROM_SIZE, F(",CSum=0x"), String(calChecksum, HEX))
+
+#if USING_WRITE_AVOIDANCE
+      bool unchanged = isEEPROMUnchanged(CONFIG_EEPROM_START, &ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config));
+
+#if USE_DYNAMIC_PARAMETERS
+      unchanged = unchanged && EEPROM_isDynamicDataUnchanged();
+#endif
+
+      if (!needsStorageWrite(unchanged))
+        return;
+#endif
+
+      EEPROM.put(CONFIG_EEPROM_START, ESP_WM_LITE_config);
+
+#if USE_DYNAMIC_PARAMETERS
+      EEPROM_putDynamicData();
+#endif
+
+      EEPROM.commit();
+    }
+
+    //////////////////////////////////////////////
+
+    void loadAndSaveDefaultConfigData()
+    {
+      // Load Default Config Data from Sketch
+      memcpy(&ESP_WM_LITE_config, &defaultConfig, sizeof(ESP_WM_LITE_config));
+      strcpy(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE);
+
+      // Including config and dynamic data, and assume valid
+      saveConfigData();
+
+      ESP_WML_LOGINFO(F("======= Start Loaded Config Data ======="));
+      displayConfigData(ESP_WM_LITE_config);
+    }
+
+    //////////////////////////////////////////////
+
+    bool getConfigData()
+    {
+      bool dynamicDataValid = true;
+      int calChecksum;
+
+      hadConfigData = false;
+
+      EEPROM.begin(EEPROM_SIZE);
+      ESP_WML_LOGINFO1(F("EEPROMsz:"), EEPROM_SIZE);
+
+      if (LOAD_DEFAULT_CONFIG_DATA)
+      {
+        // Load Config Data from Sketch
+        memcpy(&ESP_WM_LITE_config, &defaultConfig, sizeof(ESP_WM_LITE_config));
+        strcpy(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE);
+
+        // Including config and dynamic data, and assume valid
+        saveAllConfigData();
+
+        ESP_WML_LOGINFO(F("======= Start Loaded Config Data ======="));
+        displayConfigData(ESP_WM_LITE_config);
+
+        // Don't need Config Portal anymore
+        return true;
+      }
+      else
+      {
+        // Load data from EEPROM
+        EEPROM.get(CONFIG_EEPROM_START, ESP_WM_LITE_config);
+
+        if ( !isWiFiConfigValid() )
+        {
+          // If SSID, PW ="blank" or NULL, stay in config mode forever until having config Data.
+          return false;
+        }
+
+        ESP_WML_LOGINFO(F("======= Start Stored Config Data ======="));
+        displayConfigData(ESP_WM_LITE_config);
+
+        calChecksum = calcChecksum();
+
+        ESP_WML_LOGINFO3(F("CCSum=0x"), String(calChecksum, HEX),
+                         F(",RCSum=0x"), String(ESP_WM_LITE_config.checkSum, HEX));
+
+#if USE_DYNAMIC_PARAMETERS
+
+        // Load dynamic data from EEPROM
+        dynamicDataValid = EEPROM_getDynamicData();
+
+        if (dynamicDataValid)
+        {
+          ESP_WML_LOGINFO(F("Valid Stored Dynamic Data"));
+        }
+        else
+        {
+          ESP_WML_LOGINFO(F("Invalid Stored Dynamic Data. Ignored"));
+        }
+
+#endif
+      }
+
+      if ( (strncmp(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE, strlen(ESP_WM_LITE_BOARD_TYPE)) != 0) ||
+           (calChecksum != ESP_WM_LITE_config.checkSum) || !dynamicDataValid )
+      {
+        // Including Credentials CSum
+        ESP_WML_LOGINFO3(F("InitEEPROM,sz="), EEPROM_SIZE, F(",DataSz="), totalDataSize);
+
+        // doesn't have any configuration
+        if (LOAD_DEFAULT_CONFIG_DATA)
+        {
+          memcpy(&ESP_WM_LITE_config, &defaultConfig, sizeof(ESP_WM_LITE_config));
+        }
+        else
+        {
+          memset(&ESP_WM_LITE_config, 0, sizeof(ESP_WM_LITE_config));
+
+          for (uint8_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
+          {
+            strcpy(ESP_WM_LITE_config.WiFi_Creds[i].wifi_ssid,   WM_NO_CONFIG);
+            strcpy(ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw,     WM_NO_CONFIG);
+          }
+
+          strcpy(ESP_WM_LITE_config.board_name, WM_NO_CONFIG);
+
+#if USE_DYNAMIC_PARAMETERS
+
+          for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+          {
+            // Actual size of pdata is [maxlen + 1]
+            memset(myMenuItems[i].pdata, 0, myMenuItems[i].maxlen + 1);
+            strncpy(myMenuItems[i].pdata, WM_NO_CONFIG, myMenuItems[i].maxlen);
+          }
+
+#endif
+        }
+
+        strcpy(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE);
+
+#if USE_DYNAMIC_PARAMETERS
+
+        for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+        {
+          ESP_WML_LOGDEBUG3(F("g:myMenuItems["), i, F("]="), myMenuItems[i].pdata );
+        }
+
+#endif
+
+        // Don't need
+        ESP_WM_LITE_config.checkSum = 0;
+
+        saveAllConfigData();
+
+        return false;
+      }
+      else if ( !isWiFiConfigValid() )
+      {
+        // If SSID, PW ="blank" or NULL, stay in config mode forever until having config Data.
+        return false;
+      }
+      else
+      {
+        displayConfigData(ESP_WM_LITE_config);
+      }
+
+      return true;
+    }
+
+#endif    // #if ( USE_LITTLEFS || USE_SPIFFS )
+
+    //////////////////////////////////////////////
+
+#if USING_RECONNECT_BACKOFF
+
+    // Same sequence after each reset, but different for each board
+    uint32_t reconnectRandom()
+    {
+      if (_reconRandom == 0)
+        _reconRandom = ESP_getChipId();
+
+      // Weyl sequence mixed by the MurmurHash3 finalizer. Close chip IDs give unrelated values
+      uint32_t z = (_reconRandom += 0x9E3779B9UL);
+
+      z = (z ^ (z >> 16)) * 0x85EBCA6BUL;
+      z = (z ^ (z >> 13)) * 0xC2B2AE35UL;
+
+      return z ^ (z >> 16);
+    }
+
+    //////////////////////////////////////////////
+
+    // Start waiting before the next reconnection, the longer the more reconnections already failed
+    void scheduleReconnect()
+    {
+      uint32_t interval = _reconMinInterval;
+
+      for (uint16_t i = 0; (i < _reconAttempts) && (interval < _reconMaxInterval); i++)
+        interval = (interval > _reconMaxInterval / 2) ? _reconMaxInterval : interval * 2;
+
+      if (interval > _reconMaxInterval)
+        interval = _reconMaxInterval;
+
+      const uint32_t jitter = (uint32_t) ( (uint64_t) interval * _reconJitter / 100 );
+
+      if (jitter > 0)
+        interval -= reconnectRandom() % (jitter + 1);
+
+      _reconWait      = interval;
+      _reconWaitStart = millis();
+      _reconWaiting   = true;
+
+      ESP_WML_LOGINFO3(F("ReconW in ms="), _reconWait, F(", attempts="), _reconAttempts);
+    }
+
+    //////////////////////////////////////////////
+
+    // true, and counted as an attempt, once the wait is over
+    bool isReconnectDue()
+    {
+      if ( !_reconWaiting || (millis() - _reconWaitStart < _reconWait) )
+        return false;
+
+      _reconWaiting = false;
+      _reconAttempts++;
+      _reconTotalAttempts++;
+
+      return true;
+    }
+
+    //////////////////////////////////////////////
+
+    void resetReconnect()
+    {
+      _reconWaiting   = false;
+      _reconAttempts  = 0;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+    // WL_CONNECTED if the STA has an IP
+    uint8_t getWiFiLinkStatus()
+    {
+#if USING_WIFI_EVENTS
+      return _linkUp ? WL_CONNECTED : WL_DISCONNECTED;
+#else
+      return WiFi.status();
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+#if USING_WIFI_EVENTS
+
+    // Only flags are set in the callbacks, run() does the rest
+    void beginWiFiEvents()
+    {
+      if (_wifiEventsStarted)
+        return;
+
+      _wifiEventsStarted = true;
+
+#if ESP32
+      // One registration per event, or the Config Portal AP events would call it too
+      WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info)
+      {
+        (void) event;
+        (void) info;
+
+        _linkUp = true;
+      }, ESP_WM_LITE_EVENT_STA_GOT_IP);
+
+      WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info)
+      {
+        (void) event;
+        (void) info;
+
+        _linkUp = false;
+      }, ESP_WM_LITE_EVENT_STA_LOST_IP);
+
+      WiFi.onEvent([this](WiFiEvent_t event, WiFiEventInfo_t info)
+      {
+        (void) event;
+
+        _disconnectReason = ESP_WM_LITE_DISCONNECT_REASON(info);
+        _linkUp = false;
+      }, ESP_WM_LITE_EVENT_STA_DISCONNECTED);
+#else
+      _gotIPHandler = WiFi.onStationModeGotIP([this](const WiFiEventStationModeGotIP & event)
+      {
+        (void) event;
+
+        _linkUp = true;
+      });
+
+      _disconnectedHandler = WiFi.onStationModeDisconnected([this](const WiFiEventStationModeDisconnected & event)
+      {
+        _disconnectReason = event.reason;
+        _linkUp = false;
+      });
+#endif
+
+      // In case already connected, e.g. by the SDK auto-connect
+      _linkUp = (WiFi.status() == WL_CONNECTED);
+
+      ESP_WML_LOGDEBUG1(F("WiFi events, linkUp="), (bool) _linkUp);
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+    // New connectMultiWiFi() logic from v1.7.0
+    // Max times to try WiFi per loop() iteration. To avoid blocking issue in loop()
+    // Default 1 and minimum 1.
+#if !defined(MAX_NUM_WIFI_RECON_TRIES_PER_LOOP)
+#define MAX_NUM_WIFI_RECON_TRIES_PER_LOOP     1
+#else
+#if (MAX_NUM_WIFI_RECON_TRIES_PER_LOOP < 1)
+#define MAX_NUM_WIFI_RECON_TRIES_PER_LOOP     1
+#endif
+#endif
+
+    uint8_t connectMultiWiFi()
+    {
+#if ESP32
+      // For ESP32, this better be 0 to shorten the connect time.
+      // For ESP32-S2/C3, must be > 500
+#if ( USING_ESP32_S2 || USING_ESP32_C3 )
+#define WIFI_MULTI_1ST_CONNECT_WAITING_MS           500L
+#else
+      // For ESP32 core v1.0.6, must be >= 500
+#define WIFI_MULTI_1ST_CONNECT_WAITING_MS           800L
+#endif
+#else
+      // For ESP8266, this better be 2200 to enable connect the 1st time
+#define WIFI_MULTI_1ST_CONNECT_WAITING_MS             2200L
+#endif
+
+#define WIFI_MULTI_CONNECT_WAITING_MS                   500L
+
+      uint8_t status;
+
+      ESP_WML_LOGINFO(F("Connecting MultiWifi..."));
+
+      WiFi.mode(WIFI_STA);
+
+      setHostname();
+
+      int i = 0;
+
+#if USING_CREDS_RANKING
+      _credsAttemptStart = millis();
+#endif
+
+      status = WL_DISCONNECTED;
+
+#if USING_FAST_CONNECT
+      status = connectFastWiFi();
+#endif
+
+#if USING_SCAN_CONNECT
+
+      if (status != WL_CONNECTED)
+        status = connectScanWiFi();
+
+#endif
+
+      if (status != WL_CONNECTED)
+      {
+        status = wifiMulti.run();
+        delay(WIFI_MULTI_1ST_CONNECT_WAITING_MS);
+      }
 
       uint8_t numWiFiReconTries = 0;
 
-      while ( ( status != WL_CONNECTED ) && (numWiFiReconTries++ < MAX_NUM_WIFI_RECON_TRIES_PER_LOOP) )
+      while ( ( status != WL_CONNECTED ) && (numWiFiReconTries++ < MAX_NUM_WIFI_RECON_TRIES_PER_LOOP) )
+      {
+        status = WiFi.status();
+
+        if ( status == WL_CONNECTED )
+          break;
+        else
+          delay(WIFI_MULTI_CONNECT_WAITING_MS);
+      }
+
+      if ( status == WL_CONNECTED )
+      {
+#if USING_FAST_CONNECT
+        saveFastConnect(getWiFiCredsIndex(WiFi.SSID()));
+#endif
+
+#if USING_CREDS_RANKING
+        recordCredsSuccess(getWiFiCredsIndex(WiFi.SSID()), millis() - _credsAttemptStart);
+#endif
+
+#if USING_SCAN_CONNECT
+        saveLastBSSID();
+#endif
+
+#if USING_DHCP_CACHE
+        startLeaseProbe();
+#endif
+
+        ESP_WML_LOGWARN1(F("WiFi connected after time: "), i);
+        ESP_WML_LOGWARN3(F("SSID="), WiFi.SSID(), F(",RSSI="), WiFi.RSSI());
+        ESP_WML_LOGWARN3(F("Channel="), WiFi.channel(), F(",IP="), WiFi.localIP() );
+      }
+      else
+      {
+        ESP_WML_LOGERROR(F("WiFi not connected"));
+
+#if USING_CREDS_RANKING
+
+        // wifiMulti tried all it could see
+        for (uint8_t index = 0; index < NUM_WIFI_CREDENTIALS; index++)
+        {
+          if (strlen(ESP_WM_LITE_config.WiFi_Creds[index].wifi_pw) >= PASSWORD_MIN_LEN)
+            recordCredsFailure(index);
+        }
+
+#endif
+
+#if RESET_IF_NO_WIFI
+
+#if USING_MRD
+        // To avoid unnecessary MRD
+        mrd->loop();
+#else
+        // To avoid unnecessary DRD
+        drd->loop();
+#endif
+
+        resetFunc();
+
+#endif
+      }
+
+      return status;
+    }
+
+    //////////////////////////////////////////////
+
+    // Index in WiFi_Creds[] of ssid, NUM_WIFI_CREDENTIALS if none
+    uint8_t getWiFiCredsIndex(const String& ssid)
+    {
+      uint8_t index = 0;
+
+      while ( (index < NUM_WIFI_CREDENTIALS) && strcmp(ssid.c_str(), ESP_WM_LITE_config.WiFi_Creds[index].wifi_ssid) )
+        index++;
+
+      return index;
+    }
+
+    //////////////////////////////////////////////
+
+#if USING_CREDS_RANKING
+
+    // Whether WiFi_Creds[a] is more likely to connect than WiFi_Creds[b]
+    bool isCredsBetter(const uint8_t& a, const uint8_t& b)
+    {
+      const ESP_WM_LITE_Creds_Stats& sa = _credsStats[a];
+      const ESP_WM_LITE_Creds_Stats& sb = _credsStats[b];
+
+      if (sa.failuresInRow != sb.failuresInRow)
+        return (sa.failuresInRow < sb.failuresInRow);
+
+      if (sa.lastSuccess != sb.lastSuccess)
+      {
+        // Never connected last. Compare ages, not millis(), to be right across its rollover
+        if (!sa.lastSuccess || !sb.lastSuccess)
+          return (sa.lastSuccess != 0);
+
+        return ( (millis() - sa.lastSuccess) < (millis() - sb.lastSuccess) );
+      }
+
+      if (sa.avgLatency != sb.avgLatency)
+        return (sa.avgLatency < sb.avgLatency);
+
+      return (a < b);
+    }
+
+    //////////////////////////////////////////////
+
+    // Sort _credsOrder[] by isCredsBetter(). Insertion sort, as NUM_WIFI_CREDENTIALS <= 16
+    void rankCredentials()
+    {
+      for (uint8_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
+      {
+        uint8_t j = i;
+
+        while ( (j > 0) && isCredsBetter(i, _credsOrder[j - 1]) )
+        {
+          _credsOrder[j] = _credsOrder[j - 1];
+          j--;
+        }
+
+        _credsOrder[j] = i;
+      }
+
+      ESP_WML_LOGDEBUG1(F("Rank1st="), _credsOrder[0]);
+    }
+
+    //////////////////////////////////////////////
+
+    // Connected with WiFi_Creds[index] after latency ms, 0 if not timed
+    void recordCredsSuccess(const uint8_t& index, const uint32_t& latency)
+    {
+      if (index >= NUM_WIFI_CREDENTIALS)
+        return;
+
+      ESP_WM_LITE_Creds_Stats& stats = _credsStats[index];
+
+      stats.lastSuccess   = millis() | 1;
+      stats.failuresInRow = 0;
+
+      if (stats.successes < 0xFFFF)
+        stats.successes++;
+
+      if (latency)
+      {
+        // Mean of the first connections, then moving average over the last CREDS_LATENCY_WEIGHT
+        const uint32_t weight = (stats.successes < CREDS_LATENCY_WEIGHT) ? stats.successes : CREDS_LATENCY_WEIGHT;
+
+        stats.avgLatency = ( stats.avgLatency * (weight - 1) + latency ) / weight;
+      }
+
+      ESP_WML_LOGDEBUG3(F("Creds#"), index, F(" ms="), stats.avgLatency);
+    }
+
+    //////////////////////////////////////////////
+
+    void recordCredsFailure(const uint8_t& index)
+    {
+      if (index >= NUM_WIFI_CREDENTIALS)
+        return;
+
+      ESP_WM_LITE_Creds_Stats& stats = _credsStats[index];
+
+      if (stats.failures < 0xFFFF)
+        stats.failures++;
+
+      if (stats.failuresInRow < 0xFF)
+        stats.failuresInRow++;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if (USING_SCAN_CONNECT || USING_ROAMING)
+
+    // Strongest AP of the stored SSIDs (only of WiFi_Creds[onlyIndex] if valid) in the n scan results, the preferred
+    // AP counting hysteresis dB more. Ties go to the better ranked credentials. false if none
+    bool selectScanAP(const int& n, ESP_WM_LITE_AP_Candidate& best, const uint8_t* preferred, const int32_t& hysteresis,
+                      const uint8_t& onlyIndex = NUM_WIFI_CREDENTIALS)
+    {
+      uint32_t ssidHash[NUM_WIFI_CREDENTIALS];
+      uint32_t ssidBloom = 0;
+
+      // Each scanned SSID is hashed once, and only compared to the stored SSIDs if it may be one
+      for (uint8_t index = 0; index < NUM_WIFI_CREDENTIALS; index++)
+      {
+        const WiFi_Credentials& creds = ESP_WM_LITE_config.WiFi_Creds[index];
+
+        ssidHash[index] = hashBytes(creds.wifi_ssid, strlen(creds.wifi_ssid));
+
+        if ( (strlen(creds.wifi_pw) >= PASSWORD_MIN_LEN) && ( (onlyIndex >= NUM_WIFI_CREDENTIALS) || (index == onlyIndex) ) )
+          ssidBloom |= 1UL << (ssidHash[index] & 31);
+      }
+
+      bool    found     = false;
+      int32_t bestScore = 0;
+      uint8_t bestRank  = 0;
+
+      for (int i = 0; i < n; i++)
+      {
+        const String    ssid  = WiFi.SSID(i);
+        const uint32_t  hash  = hashBytes(ssid.c_str(), ssid.length());
+
+        if ( !(ssidBloom & (1UL << (hash & 31))) )
+          continue;
+
+        for (uint8_t rank = 0; rank < NUM_WIFI_CREDENTIALS; rank++)
+        {
+          const uint8_t index = getCredsOrder(rank);
+          const WiFi_Credentials& creds = ESP_WM_LITE_config.WiFi_Creds[index];
+
+          if ( ( (onlyIndex < NUM_WIFI_CREDENTIALS) && (index != onlyIndex) ) || (ssidHash[index] != hash) ||
+               (strlen(creds.wifi_pw) < PASSWORD_MIN_LEN) || strcmp(ssid.c_str(), creds.wifi_ssid) )
+            continue;
+
+          const uint8_t* bssid = WiFi.BSSID(i);
+
+          if (!bssid)
+            break;
+
+          int32_t score = WiFi.RSSI(i);
+
+          if ( preferred && !memcmp(bssid, preferred, sizeof(best.bssid)) )
+            score += hysteresis;
+
+          if ( !found || (score > bestScore) || ( (score == bestScore) && (rank < bestRank) ) )
+          {
+            found         = true;
+            bestScore     = score;
+            bestRank      = rank;
+            best.index    = index;
+            best.channel  = WiFi.channel(i);
+            best.rssi     = WiFi.RSSI(i);
+            memcpy(best.bssid, bssid, sizeof(best.bssid));
+          }
+
+          break;
+        }
+      }
+
+      return found;
+    }
+
+    //////////////////////////////////////////////
+
+    void beginScanAP(const ESP_WM_LITE_AP_Candidate& ap)
+    {
+      const WiFi_Credentials& creds = ESP_WM_LITE_config.WiFi_Creds[ap.index];
+
+      ESP_WML_LOGINFO5(F("Scan con2:"), creds.wifi_ssid, F(", Ch="), ap.channel, F(", RSSI="), ap.rssi);
+
+      WiFi.begin(creds.wifi_ssid, creds.wifi_pw, ap.channel, ap.bssid);
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if USING_SCAN_CONNECT
+
+    // For the hysteresis of selectScanAP()
+    void saveLastBSSID()
+    {
+      const uint8_t* bssid = WiFi.BSSID();
+
+      if (bssid)
+      {
+        memcpy(_lastBSSID, bssid, sizeof(_lastBSSID));
+        _hasLastBSSID = true;
+      }
+    }
+
+    //////////////////////////////////////////////
+
+    // Blocking, for connectMultiWiFi(). WL_CONNECTED if connected to the AP chosen by selectScanAP()
+    uint8_t connectScanWiFi()
+    {
+      ESP_WM_LITE_AP_Candidate ap;
+
+      const bool found = selectScanAP(WiFi.scanNetworks(), ap, _hasLastBSSID ? _lastBSSID : NULL, SCAN_CONNECT_HYSTERESIS);
+
+      WiFi.scanDelete();
+
+      if (!found)
+      {
+        ESP_WML_LOGINFO(F("Scan: no known AP"));
+        return WL_DISCONNECTED;
+      }
+
+      beginScanAP(ap);
+
+      unsigned long startMillis = millis();
+
+      while ( (WiFi.status() != WL_CONNECTED) && (millis() - startMillis < TIMEOUT_RECONNECT_WIFI) )
+      {
+        delay(50);
+      }
+
+      if (WiFi.status() == WL_CONNECTED)
+      {
+        ESP_WML_LOGINFO1(F("Scan connected after ms: "), millis() - startMillis);
+        return WL_CONNECTED;
+      }
+
+      ESP_WML_LOGINFO(F("Scan connect failed"));
+      WiFi.disconnect();
+
+      return WL_DISCONNECTED;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if USING_ROAMING
+
+    // Called from run(). Samples the RSSI, scans and moves to a stronger AP. true while moving
+    bool checkRoaming()
+    {
+      const bool linkUp = (getWiFiLinkStatus() == WL_CONNECTED);
+
+      if (_roaming)
+      {
+        if (linkUp)
+        {
+          ESP_WML_LOGWARN3(F("Roamed,RSSI="), WiFi.RSSI(), F(",Ch="), WiFi.channel());
+
+          _roaming = false;
+
+#if USING_FAST_CONNECT
+          saveFastConnect(getWiFiCredsIndex(WiFi.SSID()));
+#endif
+
+#if USING_SCAN_CONNECT
+          saveLastBSSID();
+#endif
+        }
+        else if (millis() - _roamLastMove > ROAMING_TIMEOUT)
+        {
+          ESP_WML_LOGERROR(F("Roam failed"));
+          _roaming = false;
+        }
+
+        return _roaming;
+      }
+
+      if (configuration_mode || !linkUp)
+      {
+        if (_roamScanning)
+        {
+          WiFi.scanDelete();
+          _roamScanning = false;
+        }
+
+        _roamRSSI       = 0;
+        _roamLowSamples = 0;
+
+        return false;
+      }
+
+      if (_roamScanning)
+      {
+        pollRoamScan();
+        return _roaming;
+      }
+
+      if (millis() - _roamLastSample < ROAMING_SAMPLE_INTERVAL)
+        return false;
+
+      _roamLastSample = millis();
+
+      // Smoothed over about 4 samples, against fading
+      const int32_t rssi = WiFi.RSSI();
+
+      _roamRSSI = _roamRSSI ? (3 * _roamRSSI + rssi) / 4 : rssi;
+
+      if (_roamRSSI >= ROAMING_RSSI_THRESHOLD)
+      {
+        _roamLowSamples = 0;
+        return false;
+      }
+
+      if ( (++_roamLowSamples < ROAMING_LOW_SAMPLES) ||
+           ( _roamScans && (millis() - _roamLastScan < ROAMING_SCAN_INTERVAL) ) ||
+           ( _roamMoves && (millis() - _roamLastMove < ROAMING_MOVE_INTERVAL) ) )
+        return false;
+
+      ESP_WML_LOGINFO1(F("Roam scan,RSSI="), _roamRSSI);
+
+      _roamLastScan = millis();
+
+      if (WiFi.scanNetworks(true) != WIFI_SCAN_FAILED)
+      {
+        _roamScanning = true;
+        _roamScans++;
+      }
+
+      return false;
+    }
+
+    //////////////////////////////////////////////
+
+    // When the background scan is done, WiFi.begin() to the AP of the same SSID chosen by selectScanAP(), if stronger
+    // by more than ROAMING_HYSTERESIS dB
+    void pollRoamScan()
+    {
+      const int n = WiFi.scanComplete();
+
+      if ( (n == WIFI_SCAN_RUNNING) && (millis() - _roamLastScan < ROAMING_TIMEOUT) )
+        return;
+
+      _roamScanning = false;
+
+      const uint8_t* bssid = WiFi.BSSID();
+      const uint8_t  index = getWiFiCredsIndex(WiFi.SSID());
+
+      ESP_WM_LITE_AP_Candidate ap;
+      uint8_t current[6] = { 0 };
+
+      if (bssid)
+        memcpy(current, bssid, sizeof(current));
+
+      const bool found = (index < NUM_WIFI_CREDENTIALS) && selectScanAP(n, ap, current, ROAMING_HYSTERESIS, index);
+
+      WiFi.scanDelete();
+
+      // The current AP may not be in the results : compare to its sampled RSSI too
+      if ( !found || !memcmp(ap.bssid, current, sizeof(current)) || (ap.rssi <= _roamRSSI + ROAMING_HYSTERESIS) )
+      {
+        ESP_WML_LOGDEBUG(F("Roam: no better AP"));
+        return;
+      }
+
+      ESP_WML_LOGWARN3(F("Roam from RSSI="), _roamRSSI, F(" to "), ap.rssi);
+
+      beginScanAP(ap);
+
+      _roaming        = true;
+      _roamLastMove   = millis();
+      _roamMoves++;
+      _roamRSSI       = 0;
+      _roamLowSamples = 0;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if USING_FAST_CONNECT
+
+    uint32_t getFastConnectCredsHash(const uint8_t& index)
+    {
+      const WiFi_Credentials& creds = ESP_WM_LITE_config.WiFi_Creds[index];
+
+      uint32_t hash = hashBytes(creds.wifi_ssid, strlen(creds.wifi_ssid) + 1);
+
+      return hashBytes(creds.wifi_pw, strlen(creds.wifi_pw), hash);
+    }
+
+    //////////////////////////////////////////////
+
+    // Last connection's AP, if still valid for the current credentials
+    bool loadFastConnect(ESP_WM_LITE_Fast_Connect& record)
+    {
+#if ESP8266
+      ESP.rtcUserMemoryRead(FAST_CONNECT_RTC_OFFSET, (uint32_t *) &record, sizeof(record));
+#else
+      memcpy(&record, &ESP_WM_LITE_fastConnectRTC, sizeof(record));
+#endif
+
+      return ( (record.magic == FAST_CONNECT_MAGIC) &&
+               (record.checksum == hashBytes(&record, sizeof(record) - sizeof(record.checksum))) &&
+               (record.index < NUM_WIFI_CREDENTIALS) && (record.credsHash == getFastConnectCredsHash(record.index)) );
+    }
+
+    //////////////////////////////////////////////
+
+    void writeFastConnect(ESP_WM_LITE_Fast_Connect& record)
+    {
+      record.checksum = hashBytes(&record, sizeof(record) - sizeof(record.checksum));
+
+#if ESP8266
+      ESP.rtcUserMemoryWrite(FAST_CONNECT_RTC_OFFSET, (uint32_t *) &record, sizeof(record));
+#else
+      memcpy(&ESP_WM_LITE_fastConnectRTC, &record, sizeof(record));
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+    // Remember the AP just connected to with WiFi_Creds[index]. Written only if changed
+    void saveFastConnect(const uint8_t& index)
+    {
+      const uint8_t* bssid = WiFi.BSSID();
+
+      if ( (index >= NUM_WIFI_CREDENTIALS) || (bssid == NULL) )
+        return;
+
+      ESP_WM_LITE_Fast_Connect record;
+
+      memset(&record, 0, sizeof(record));
+
+      record.magic      = FAST_CONNECT_MAGIC;
+      record.credsHash  = getFastConnectCredsHash(index);
+      record.channel    = WiFi.channel();
+      record.index      = index;
+      memcpy(record.bssid, bssid, sizeof(record.bssid));
+
+#if USING_DHCP_CACHE
+      // Got by DHCP, or the cached lease if used
+      record.ip         = (uint32_t) WiFi.localIP();
+      record.gateway    = (uint32_t) WiFi.gatewayIP();
+      record.subnet     = (uint32_t) WiFi.subnetMask();
+      record.dns1       = (uint32_t) WiFi.dnsIP(0);
+      record.dns2       = (uint32_t) WiFi.dnsIP(1);
+
+      // A new lease from DHCP starts at 0
+      record.leaseAge   = _usingCachedLease ? _leaseAge : 0;
+#endif
+
+      ESP_WM_LITE_Fast_Connect current;
+
+      if ( loadFastConnect(current) && !memcmp(&current, &record, sizeof(record) - sizeof(record.checksum)) )
+        return;
+
+      ESP_WML_LOGDEBUG3(F("saveFastConnect: index="), index, F(", Ch="), record.channel);
+
+      writeFastConnect(record);
+    }
+
+    //////////////////////////////////////////////
+
+    void clearFastConnect()
+    {
+      ESP_WM_LITE_Fast_Connect record;
+
+      memset(&record, 0, sizeof(record));
+
+      writeFastConnect(record);
+    }
+
+    //////////////////////////////////////////////
+
+    // WiFi.begin() to the AP and channel of the last connection, without scanning
+    void beginFastConnect(const ESP_WM_LITE_Fast_Connect& record)
+    {
+      ESP_WML_LOGINFO3(F("Fast con2:"), ESP_WM_LITE_config.WiFi_Creds[record.index].wifi_ssid, F(", Ch="), record.channel);
+
+#if USING_DHCP_CACHE
+
+      if (record.ip)
+      {
+        ESP_WML_LOGINFO1(F("UseCachedLease:"), IPAddress(record.ip));
+
+        WiFi.config(IPAddress(record.ip), IPAddress(record.gateway), IPAddress(record.subnet), IPAddress(record.dns1),
+                    IPAddress(record.dns2));
+        _usingCachedLease = true;
+        _leaseAge         = record.leaseAge;
+      }
+      else
+        useDHCP();
+
+#endif
+
+      WiFi.begin(ESP_WM_LITE_config.WiFi_Creds[record.index].wifi_ssid, ESP_WM_LITE_config.WiFi_Creds[record.index].wifi_pw,
+                 record.channel, record.bssid);
+    }
+
+    //////////////////////////////////////////////
+
+#if USING_DHCP_CACHE
+
+    // Back to DHCP, if the cached lease was set as static IP
+    void useDHCP()
+    {
+      if (!_usingCachedLease)
+        return;
+
+      ESP_WML_LOGINFO(F("UseDHCP"));
+
+      WiFi.config(IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0), IPAddress(0, 0, 0, 0));
+
+      _usingCachedLease = false;
+      _leaseProbing     = false;
+    }
+
+    //////////////////////////////////////////////
+
+    // Connected with the cached lease : check in the background that no other host answers for that IP
+    void startLeaseProbe()
+    {
+      if (!_usingCachedLease)
+        return;
+
+      _leaseProbeIP       = (uint32_t) WiFi.localIP();
+      _leaseConflict      = false;
+      _leaseProbing       = true;
+      _leaseProbeStart    = millis();
+      _leaseProbeLast     = _leaseProbeStart - DHCP_CACHE_PROBE_INTERVAL;
+      _leaseAgeSaved      = _leaseProbeStart;
+    }
+
+    //////////////////////////////////////////////
+
+    // In the lwIP thread on ESP32. ARP request for our own IP : an ARP entry for it, with a MAC other than ours,
+    // comes from another host using that IP
+    static void leaseProbeStep(void* arg)
+    {
+      ESPAsync_WiFiManager_Lite* self = (ESPAsync_WiFiManager_Lite *) arg;
+
+      ip4_addr_t ownIP;
+
+      ip4_addr_set_u32(&ownIP, self->_leaseProbeIP);
+
+      for (struct netif* probeNetif = netif_list; probeNetif; probeNetif = probeNetif->next)
+      {
+        if (ip4_addr_get_u32(netif_ip4_addr(probeNetif)) != self->_leaseProbeIP)
+          continue;
+
+        struct eth_addr* ethRet;
+        const ip4_addr_t* ipRet;
+
+        if ( (etharp_find_addr(probeNetif, &ownIP, &ethRet, &ipRet) >= 0) &&
+             memcmp(ethRet->addr, probeNetif->hwaddr, sizeof(ethRet->addr)) )
+          self->_leaseConflict = true;
+        else
+          etharp_request(probeNetif, &ownIP);
+
+        break;
+      }
+    }
+
+    //////////////////////////////////////////////
+
+    // Forget the cached lease, and get a new one by DHCP. Recorded at the next connection
+    void dropCachedLease()
+    {
+      ESP_WM_LITE_Fast_Connect record;
+
+      if (loadFastConnect(record))
+      {
+        record.ip       = 0;
+        record.leaseAge = 0;
+        writeFastConnect(record);
+      }
+
+      useDHCP();
+    }
+
+    //////////////////////////////////////////////
+
+    // Called from run(). Nothing to do but while connected with the cached lease
+    void checkLeaseProbe()
+    {
+      if ( !_usingCachedLease || (getWiFiLinkStatus() != WL_CONNECTED) )
+        return;
+
+      if (_leaseConflict)
+      {
+        ESP_WML_LOGWARN(F("CachedLease: IP in use"));
+        dropCachedLease();
+
+        return;
+      }
+
+      if (_leaseProbing)
+      {
+        if (millis() - _leaseProbeStart > DHCP_CACHE_PROBE_TIMEOUT)
+        {
+          ESP_WML_LOGINFO(F("CachedLease OK"));
+          _leaseProbing = false;
+        }
+        else if (millis() - _leaseProbeLast >= DHCP_CACHE_PROBE_INTERVAL)
+        {
+          _leaseProbeLast = millis();
+
+#if ESP32
+          tcpip_callback(leaseProbeStep, this);
+#else
+          leaseProbeStep(this);
+#endif
+        }
+      }
+
+      if (millis() - _leaseAgeSaved < DHCP_CACHE_AGE_INTERVAL)
+        return;
+
+      _leaseAge      += millis() - _leaseAgeSaved;
+      _leaseAgeSaved  = millis();
+
+      if (_leaseAge >= DHCP_CACHE_MAX_TIME)
+      {
+        // May have expired on the DHCP server
+        ESP_WML_LOGINFO(F("CachedLease: too old"));
+        dropCachedLease();
+
+        return;
+      }
+
+      ESP_WM_LITE_Fast_Connect record;
+
+      if ( loadFastConnect(record) && (record.ip == _leaseProbeIP) )
+      {
+        record.leaseAge = _leaseAge;
+        writeFastConnect(record);
+      }
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+    // Blocking, for connectMultiWiFi(). WL_CONNECTED if connected to the last connection's AP within FAST_CONNECT_TIMEOUT
+    uint8_t connectFastWiFi()
+    {
+      ESP_WM_LITE_Fast_Connect record;
+
+      if (!loadFastConnect(record))
+        return WL_DISCONNECTED;
+
+      beginFastConnect(record);
+
+      unsigned long startMillis = millis();
+
+      while ( (WiFi.status() != WL_CONNECTED) && (millis() - startMillis < FAST_CONNECT_TIMEOUT) )
+      {
+        delay(50);
+      }
+
+      if (WiFi.status() == WL_CONNECTED)
+      {
+        ESP_WML_LOGINFO1(F("Fast connected after ms: "), millis() - startMillis);
+        return WL_CONNECTED;
+      }
+
+      // Forget that AP, and try all credentials as usual
+      ESP_WML_LOGINFO(F("Fast connect failed"));
+      clearFastConnect();
+      WiFi.disconnect();
+
+#if USING_DHCP_CACHE
+      useDHCP();
+#endif
+
+      return WL_DISCONNECTED;
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+#if USING_NONBLOCKING_CONNECT
+
+    void setConnectState(const ESP_WM_LITE_Connect_State& state)
+    {
+      ESP_WML_LOGDEBUG3(F("connectState:"), _connectState, F("->"), state);
+
+      _connectState = state;
+      _connectStart = millis();
+    }
+
+    //////////////////////////////////////////////
+
+    // One bounded step of the connection : check the link status, and at most start one WiFi.begin()
+    ESP_WM_LITE_Connect_State connectWiFiStep()
+    {
+      const uint8_t status = getWiFiLinkStatus();
+
+      switch (_connectState)
+      {
+        case WM_CONNECT_CONNECTED:
+
+          if (status != WL_CONNECTED)
+          {
+#if USING_RECONNECT_BACKOFF
+            ESP_WML_LOGERROR(F("r:WLost"));
+
+            scheduleReconnect();
+            setConnectState(WM_CONNECT_BACKOFF);
+#else
+            // First try after WIFI_RECON_INTERVAL, as any later one
+            ESP_WML_LOGERROR(F("r:WLost"));
+
+            setConnectState(WM_CONNECT_BACKOFF);
+#endif
+          }
+
+          break;
+
+        case WM_CONNECT_CONNECTING:
+        case WM_CONNECT_WAITING_IP:
+
+          if (status == WL_CONNECTED)
+            setConnected();
+
+#if USING_FAST_CONNECT
+          else if (_fastConnecting && (millis() - _connectStart > FAST_CONNECT_TIMEOUT))
+          {
+            // Forget that AP, and try all credentials as usual
+            ESP_WML_LOGINFO(F("Fast connect failed"));
+            clearFastConnect();
+
+#if USING_DHCP_CACHE
+            useDHCP();
+#endif
+
+            startConnectAttempt(0);
+          }
+#endif
+
+          else if (millis() - _connectStart > TIMEOUT_RECONNECT_WIFI)
+          {
+#if USING_CREDS_RANKING
+            recordCredsFailure(_connectIndex);
+#endif
+
+#if USING_SCAN_CONNECT
+
+            if (_scanConnecting)
+            {
+              // Then each credentials as usual, without scanning again
+              startConnectAttempt(0, false);
+              break;
+            }
+
+#endif
+
+            startConnectAttempt(_connectRank + 1);
+          }
+          else if ( (_connectState == WM_CONNECT_CONNECTING) && (WiFi.RSSI() < 0) )
+          {
+            // RSSI is 0 (ESP32) or 31 (ESP8266) until associated
+            setConnectState(WM_CONNECT_WAITING_IP);
+          }
+
+          break;
+
+        case WM_CONNECT_BACKOFF:
+
+          if (status == WL_CONNECTED)
+            setConnected();
+
+#if USING_RECONNECT_BACKOFF
+          else if (isReconnectDue())
+          {
+            ESP_WML_LOGERROR1(F("r:ReconW#"), _reconAttempts);
+            startConnectAttempt(0);
+          }
+#elif (WIFI_RECON_INTERVAL > 0)
+          else if (millis() - _connectStart >= WIFI_RECON_INTERVAL)
+            startConnectAttempt(0);
+#else
+          else
+            startConnectAttempt(0);
+#endif
+
+          break;
+
+#if USING_SCAN_CONNECT
+
+        case WM_CONNECT_SCANNING:
+
+          if (status == WL_CONNECTED)
+            setConnected();
+          else
+            pollScanConnect();
+
+          break;
+#endif
+
+        default:
+
+          if (status == WL_CONNECTED)
+            setConnected();
+          else
+            startConnectAttempt(0);
+
+          break;
+      }
+
+      return _connectState;
+    }
+
+    //////////////////////////////////////////////
+
+    // WiFi.begin() with the first valid credentials from position rank of getCredsOrder() on.
+    // A new pass over all credentials when rank is 0, first to the last connection's AP or the AP found by a scan if direct
+    void startConnectAttempt(uint8_t rank, const bool& direct = true)
+    {
+#if !(USING_FAST_CONNECT || USING_SCAN_CONNECT)
+      (void) direct;
+#endif
+
+#if USING_CREDS_RANKING
+      _credsAttemptStart = millis();
+#endif
+
+#if USING_SCAN_CONNECT
+      _scanConnecting = false;
+#endif
+
+      if (rank == 0)
+      {
+        WiFi.mode(WIFI_STA);
+        setHostname();
+
+#if USING_CREDS_RANKING
+        rankCredentials();
+#endif
+
+#if USING_FAST_CONNECT
+        ESP_WM_LITE_Fast_Connect record;
+
+        _fastConnecting = direct && loadFastConnect(record);
+
+        if (_fastConnecting)
+        {
+          beginFastConnect(record);
+
+          _connectIndex = record.index;
+          _connectRank  = 0;
+          setConnectState(WM_CONNECT_CONNECTING);
+
+          return;
+        }
+#endif
+
+#if USING_SCAN_CONNECT
+
+        if ( direct && (WiFi.scanNetworks(true) != WIFI_SCAN_FAILED) )
+        {
+          setConnectState(WM_CONNECT_SCANNING);
+          return;
+        }
+
+#endif
+      }
+      else
+      {
+        // Drop the association in progress with the previous credentials
+        WiFi.disconnect();
+      }
+
+      while ( (rank < NUM_WIFI_CREDENTIALS) && !isConnectableCreds(getCredsOrder(rank)) )
+        rank++;
+
+      if (rank >= NUM_WIFI_CREDENTIALS)
+      {
+        failConnectPass();
+        return;
+      }
+
+      const uint8_t index = getCredsOrder(rank);
+
+      ESP_WML_LOGINFO1(F("Con2:"), ESP_WM_LITE_config.WiFi_Creds[index].wifi_ssid);
+
+      WiFi.begin(ESP_WM_LITE_config.WiFi_Creds[index].wifi_ssid, ESP_WM_LITE_config.WiFi_Creds[index].wifi_pw);
+
+      _connectIndex = index;
+      _connectRank  = rank;
+      setConnectState(WM_CONNECT_CONNECTING);
+    }
+
+    //////////////////////////////////////////////
+
+    // Credentials startConnectAttempt() can use. Those from begin(ssid, pass) may be of an open network
+    bool isConnectableCreds(const uint8_t& index)
+    {
+      if (_directConnect)
+        return (ESP_WM_LITE_config.WiFi_Creds[index].wifi_ssid[0] != 0);
+
+      return (strlen(ESP_WM_LITE_config.WiFi_Creds[index].wifi_pw) >= PASSWORD_MIN_LEN);
+    }
+
+    //////////////////////////////////////////////
+
+#if USING_SCAN_CONNECT
+
+    // WM_CONNECT_SCANNING : when the scan is done, WiFi.begin() to the AP chosen by selectScanAP(), if any
+    void pollScanConnect()
+    {
+      const int n = WiFi.scanComplete();
+
+      if (n == WIFI_SCAN_RUNNING)
+      {
+        if (millis() - _connectStart < SCAN_CONNECT_TIMEOUT)
+          return;
+
+#if ESP32
+        // WiFi.begin() fails while the driver is still scanning
+        ESP_WML_LOGINFO(F("Scan: timeout"));
+
+        esp_wifi_scan_stop();
+        WiFi.scanDelete();
+
+        startConnectAttempt(0, false);
+#else
+        // Can't be stopped, but always ends : wait for it, and use its results
+        if (!_scanConnectTimedOut)
+        {
+          ESP_WML_LOGINFO(F("Scan: timeout"));
+          _scanConnectTimedOut = true;
+        }
+#endif
+
+        return;
+      }
+
+#if ESP8266
+      _scanConnectTimedOut = false;
+#endif
+
+      ESP_WM_LITE_AP_Candidate ap;
+
+      const bool found = selectScanAP(n, ap, _hasLastBSSID ? _lastBSSID : NULL, SCAN_CONNECT_HYSTERESIS);
+
+      WiFi.scanDelete();
+
+      if (!found)
+      {
+        ESP_WML_LOGINFO(F("Scan: no known AP"));
+        startConnectAttempt(0, false);
+
+        return;
+      }
+
+      beginScanAP(ap);
+
+      _scanConnecting = true;
+      _connectIndex   = ap.index;
+      _connectRank    = 0;
+      setConnectState(WM_CONNECT_CONNECTING);
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+    void setConnected()
+    {
+#if USING_CREDS_RANKING
+
+      // Not timed if the link came back by itself while waiting
+      if ( (_connectState == WM_CONNECT_CONNECTING) || (_connectState == WM_CONNECT_WAITING_IP) )
+        recordCredsSuccess(_connectIndex, millis() - _credsAttemptStart);
+      else
+        recordCredsSuccess(getWiFiCredsIndex(WiFi.SSID()), 0);
+
+#endif
+
+      setConnectState(WM_CONNECT_CONNECTED);
+
+      _connectedOnce        = true;
+      _connectPassFailures  = 0;
+
+#if USING_RECONNECT_BACKOFF
+      resetReconnect();
+#endif
+
+#if USING_FAST_CONNECT
+      _fastConnecting = false;
+      saveFastConnect(_connectIndex);
+#endif
+
+#if USING_SCAN_CONNECT
+      _scanConnecting = false;
+      saveLastBSSID();
+#endif
+
+#if USING_DHCP_CACHE
+      startLeaseProbe();
+#endif
+
+      ESP_WML_LOGWARN3(F("SSID="), WiFi.SSID(), F(",RSSI="), WiFi.RSSI());
+      ESP_WML_LOGWARN3(F("Channel="), WiFi.channel(), F(",IP="), WiFi.localIP() );
+
+#if USE_LED_BUILTIN
+      // turn the LED_BUILTIN OFF to tell us we exit configuration mode.
+      digitalWrite(LED_BUILTIN, LED_OFF);
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+    // No credentials worked. As connectMultiWiFi() failing in begin() or run()
+    void failConnectPass()
+    {
+      ESP_WML_LOGERROR(F("WiFi not connected"));
+
+#if RESET_IF_NO_WIFI
+
+#if USING_MRD
+      // To avoid unnecessary MRD
+      if (mrd)
+        mrd->loop();
+#else
+      // To avoid unnecessary DRD
+      if (drd)
+        drd->loop();
+#endif
+
+      resetFunc();
+
+#endif
+
+      if (configuration_mode)
+      {
+#if RESET_IF_CONFIG_TIMEOUT
+
+        // Config Portal timed out. Permit CONFIG_TIMEOUT_RETRYTIMES_BEFORE_RESET passes before reset hardware
+        if (++_connectPassFailures > CONFIG_TIMEOUT_RETRYTIMES_BEFORE_RESET)
+          resetFunc();
+
+        ESP_WML_LOGINFO1(F("run: WiFi lost, configTimeout. Connect WiFi. Retry#:"), _connectPassFailures);
+
+#endif
+      }
+      else if ( !_connectedOnce && hadConfigData )
+      {
+        ESP_WML_LOGINFO(F("bg: Fail2connect WiFi"));
+
+        // Never connected since begin() : start configuration mode
+        startConfigurationMode();
+
+        return;
+      }
+
+#if USING_RECONNECT_BACKOFF
+      scheduleReconnect();
+#endif
+
+      setConnectState(WM_CONNECT_BACKOFF);
+    }
+
+#endif
+
+    //////////////////////////////////////////////
+
+    // NEW
+    void createHTML(String& root_html_template)
+    {
+      String pitem;
+
+      root_html_template = "";
+
+#if ( USING_ASYNC_WIFI_SCAN && !USING_SCAN_CACHE )
+      const bool scanning = _scanRunning;
+#else
+      const bool scanning = false;
+#endif
+
+      for (uint16_t part = 0; createHTMLPart(part, pitem, scanning); part++)
+      {
+        root_html_template += pitem;
+      }
+    }
+
+    //////////////////////////////////////////////
+
+    // Template of one part of the page, with its slot markers. Parts are the head, each WiFi_Creds[], the board name,
+    // each MenuItem, then the tail. false after the last part. scanning to have the page poll for the SSID list
+    bool createHTMLPart(const uint16_t& part, String& pitem, const bool& scanning)
+    {
+#if USE_DYNAMIC_PARAMETERS
+      const uint16_t numMenuItems = NUM_MENU_ITEMS;
+#else
+      const uint16_t numMenuItems = 0;
+#endif
+
+      const uint16_t credsPart    = 1;
+      const uint16_t boardPart    = credsPart + NUM_WIFI_CREDENTIALS;
+      const uint16_t menuItemPart = boardPart + 1;
+      const uint16_t tailPart     = menuItemPart + numMenuItems;
+
+      (void) scanning;
+
+      if (part == 0)
+      {
+        pitem = FPSTR(ESP_WM_LITE_HTML_HEAD_START);
+
+#if USING_GZIPPED_ASSETS
+  #define ESP_WM_LITE_HTML_DEFAULT_STYLE    ESP_WM_LITE_HTML_CSS_LINK
+#else
+  #define ESP_WM_LITE_HTML_DEFAULT_STYLE    ESP_WM_LITE_HTML_HEAD_STYLE
+#endif
+
+#if USING_CUSTOMS_STYLE
+
+        // Using Customs style when not NULL
+        if (_CustomsHeadStyle)
+          pitem += FPSTR(_CustomsHeadStyle);
+        else
+          pitem += FPSTR(ESP_WM_LITE_HTML_DEFAULT_STYLE);
+
+#else
+        pitem += FPSTR(ESP_WM_LITE_HTML_DEFAULT_STYLE);
+#endif
+
+#if USING_CUSTOMS_HEAD_ELEMENT
+
+        if (_CustomsHeadElement)
+          pitem += _CustomsHeadElement;
+
+#endif
+
+        pitem += FPSTR(ESP_WM_LITE_HTML_HEAD_END);
+      }
+      else if (part < boardPart)
+      {
+        const uint8_t i = part - credsPart;
+
+        const String suffix = (i == 0) ? String("") : String(i);
+
+        pitem = String(FPSTR(ESP_WM_LITE_HTML_CREDS));
+
+#if ( SCAN_WIFI_NETWORKS && MANUAL_SSID_INPUT_ALLOWED )
+        // All inputs share the same datalist, added once below
+        pitem.replace("[[input_id]]", "<input id='id{n}' list='SSIDs'>");
+#elif !SCAN_WIFI_NETWORKS
+        pitem.replace("[[input_id]]", FPSTR(ESP_WM_LITE_HTML_INPUT_ID));
+#endif
+
+        pitem.replace("{r}", (i < NUM_REQUIRED_WIFI_CREDENTIALS) ? "*" : "");
+        pitem.replace("{n}", suffix);
+
+#if ( SCAN_WIFI_NETWORKS && !MANUAL_SSID_INPUT_ALLOWED )
+        // Last, as SSIDs can contain anything
+        pitem.replace("[[input_id]]", "<select id='id" + suffix + "'>" + ListOfSSIDs + FPSTR(ESP_WM_LITE_SELECT_END));
+#endif
+      }
+      else if (part == boardPart)
+      {
+        pitem = "";
+
+#if ( SCAN_WIFI_NETWORKS && MANUAL_SSID_INPUT_ALLOWED )
+        pitem += String(FPSTR(ESP_WM_LITE_DATALIST_START)) + "'SSIDs'>" + ListOfSSIDs + FPSTR(ESP_WM_LITE_DATALIST_END);
+#endif
+
+        pitem += FPSTR(ESP_WM_LITE_HTML_BOARD_NAME);
+
+#if ( SCAN_WIFI_NETWORKS && USING_SCAN_CACHE )
+        pitem += FPSTR(ESP_WM_LITE_HTML_RESCAN);
+#endif
+
+        pitem += FPSTR(ESP_WM_LITE_FLDSET_START);
+      }
+      else if (part < tailPart)
+      {
+#if USE_DYNAMIC_PARAMETERS
+        const uint16_t i = part - menuItemPart;
+
+        pitem = String(FPSTR(ESP_WM_LITE_HTML_PARAM));
+
+        pitem.replace("{b}", myMenuItems[i].displayName);
+        pitem.replace("{v}", myMenuItems[i].id);
+        pitem.replace("{i}", myMenuItems[i].id);
+#endif
+      }
+      else if (part == tailPart)
+      {
+#if USING_GZIPPED_ASSETS
+
+        pitem = String(FPSTR(ESP_WM_LITE_FLDSET_END)) + FPSTR(ESP_WM_LITE_HTML_BUTTON) + FPSTR(ESP_WM_LITE_HTML_JS_LINK);
+
+#else
+
+        pitem = String(FPSTR(ESP_WM_LITE_FLDSET_END)) + FPSTR(ESP_WM_LITE_HTML_BUTTON) + FPSTR(ESP_WM_LITE_HTML_SCRIPT);
+
+#endif    // USING_GZIPPED_ASSETS
+
+#if USING_SCAN_CACHE
+
+        pitem += FPSTR(ESP_WM_LITE_HTML_SCAN_LIST);
+
+#elif USING_ASYNC_WIFI_SCAN
+
+        if (scanning)
+          pitem += FPSTR(ESP_WM_LITE_HTML_SCAN_POLL);
+
+#endif
+
+        pitem += FPSTR(ESP_WM_LITE_HTML_END);
+      }
+      else
+      {
+        pitem = "";
+
+        return false;
+      }
+
+      return true;
+    }
+
+    //////////////////////////////////////////////
+
+#if SCAN_WIFI_NETWORKS
+
+    // SSIDs of the last scan, in HTML <option> format. Built into list, to be published to ListOfSSIDs in one go
+    void buildListOfSSIDs(String& list)
+    {
+      ESP_WML_LOGDEBUG1(WiFiNetworksFound, F(" SSIDs found, generating HTML now"));
+
+      list = "";
+
+      for (int i = 0, list_items = 0; (i < WiFiNetworksFound) && (list_items < MAX_SSID_IN_LIST); i++)
+      {
+        if (indices[i] == -1)
+          continue;     // skip duplicates and those that are below the required quality
+
+        list += String(FPSTR(ESP_WM_LITE_OPTION_START)) + String(WiFi.SSID(indices[i])) + String(FPSTR(ESP_WM_LITE_OPTION_END));
+        list_items++;   // Count number of suitable, distinct SSIDs to be included in list
+      }
+
+      ESP_WML_LOGDEBUG(list);
+
+      if (list == "")    // No SSID found or none was good enough
+        list = String(FPSTR(ESP_WM_LITE_OPTION_START)) + String(FPSTR(ESP_WM_LITE_NO_NETWORKS_FOUND)) + String(FPSTR(ESP_WM_LITE_OPTION_END));
+    }
+
+#endif
+
+    //////////////////////////////////////////////
+
+    // Map the name inside a "[[...]]" marker to its slot. WM_HTML_SLOT_NONE if unknown
+    int16_t getHTMLSlot(const char* name, const size_t& len)
+    {
+      if ( (len >= 2) && ( !strncmp(name, "id", 2) || !strncmp(name, "pw", 2) ) )
+      {
+        // "id" / "pw" for WiFi_Creds[0], then "id1" / "pw1"...
+        uint16_t index = 0;
+        size_t   i     = 2;
+
+        // At most 2 digits, as NUM_WIFI_CREDENTIALS <= 16
+        for ( ; (i < len) && (i < 4) && isdigit(name[i]); i++)
+          index = (index * 10) + (name[i] - '0');
+
+        if ( (i == len) && (index < NUM_WIFI_CREDENTIALS) && ( (len == 2) || ( (index > 0) && (name[2] != '0') ) ) )
+          return WM_HTML_SLOT_CREDS + (2 * index) + ( (name[0] == 'p') ? 1 : 0 );
+      }
+
+#if USING_BOARD_NAME
+      if ( (len == 2) && !strncmp(name, "nm", len) )
+        return WM_HTML_SLOT_NM;
+#endif
+
+#if USE_DYNAMIC_PARAMETERS
+
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      {
+        if ( (strlen(myMenuItems[i].id) == len) && !strncmp(name, myMenuItems[i].id, len) )
+          return WM_HTML_SLOT_MENU_ITEM + i;
+      }
+
+#endif
+
+      return WM_HTML_SLOT_NONE;
+    }
+
+    //////////////////////////////////////////////
+
+    // Next slot marker from searchFrom : the title at titleMark, if not NULL yet, or a known "[[...]]" marker.
+    // Unknown "[[...]]" markers are skipped, as literal text. WM_HTML_SLOT_NONE if no slot left
+    int16_t findHTMLSlot(const char* searchFrom, const char*& titleMark, const char*& marker, const char*& markerEnd)
+    {
+      // RAM copies of the markers, as strstr() can't search for PROGMEM strings
+      char slotStart[sizeof(ESP_WM_LITE_HTML_SLOT_START)];
+      char slotEnd  [sizeof(ESP_WM_LITE_HTML_SLOT_END)];
+
+      const size_t slotStartLen = sizeof(slotStart) - 1;
+      const size_t slotEndLen   = sizeof(slotEnd)   - 1;
+
+      strcpy_P(slotStart, ESP_WM_LITE_HTML_SLOT_START);
+      strcpy_P(slotEnd,   ESP_WM_LITE_HTML_SLOT_END);
+
+      while (true)
+      {
+        marker = strstr(searchFrom, slotStart);
+
+        if ( titleMark && ( !marker || (titleMark < marker) ) )
+        {
+          marker    = titleMark;
+          markerEnd = titleMark + sizeof(ESP_WM_LITE_HTML_TITLE_SLOT) - 1;
+          titleMark = nullptr;
+
+          return WM_HTML_SLOT_TITLE;
+        }
+
+        if (!marker)
+          return WM_HTML_SLOT_NONE;
+
+        const char* nameEnd = strstr(marker + slotStartLen, slotEnd);
+
+        if (nameEnd)
+        {
+          const int16_t slot = getHTMLSlot(marker + slotStartLen, nameEnd - marker - slotStartLen);
+
+          if (slot != WM_HTML_SLOT_NONE)
+          {
+            markerEnd = nameEnd + slotEndLen;
+
+            return slot;
+          }
+        }
+
+        // Not one of ours. Keep it as literal text and look further
+        searchFrom = marker + slotStartLen;
+      }
+    }
+
+    //////////////////////////////////////////////
+
+    void clearHTMLSlots()
+    {
+      // Not while a response is being rendered or streamed from the template
+      ESP_WM_LITE_LOCK_PORTAL();
+
+      if (_htmlSpans)
+      {
+        delete [] _htmlSpans;
+        _htmlSpans = nullptr;
+      }
+
+      if (_htmlBuffer)
+      {
+        delete [] _htmlBuffer;
+        _htmlBuffer = nullptr;
+      }
+
+      _numHtmlSpans       = 0;
+      _htmlLiteralsLength = 0;
+
+#if USING_HTML_CACHE
+      _htmlCache.reset();
+
+      // Template changed : the ETag says nothing about the next page anymore
+      _htmlETag[0] = 0;
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+    // Parse the page template once into literal spans and slots, so that each request
+    // only has to fill in the slots, instead of rescanning the whole page per placeholder
+    bool buildHTMLSlots()
+    {
+      String root_html_template;
+
+      clearHTMLSlots();
+
+      createHTML(root_html_template);
+
+      // RAM copies of the markers, as strstr() can't search for PROGMEM strings
+      char title    [sizeof(ESP_WM_LITE_HTML_TITLE_SLOT)];
+      char slotStart[sizeof(ESP_WM_LITE_HTML_SLOT_START)];
+
+      const size_t slotStartLen = sizeof(slotStart) - 1;
+
+      strcpy_P(title,     ESP_WM_LITE_HTML_TITLE_SLOT);
+      strcpy_P(slotStart, ESP_WM_LITE_HTML_SLOT_START);
+
+      _htmlBuffer = new char[root_html_template.length() + 1];
+
+      if (!_htmlBuffer)
+      {
+        ESP_WML_LOGERROR(F("HTML: Error can't alloc template"));
+        return false;
+      }
+
+      memcpy(_htmlBuffer, root_html_template.c_str(), root_html_template.length() + 1);
+
+      // Worst case : one span per slot marker, plus title and trailing literal
+      uint16_t maxSpans = 2;
+
+      for (const char* p = strstr(_htmlBuffer, slotStart); p; p = strstr(p + slotStartLen, slotStart))
+      {
+        maxSpans++;
+      }
+
+      _htmlSpans = new ESP_WM_LITE_HTML_Span[maxSpans];
+
+      if (!_htmlSpans)
+      {
+        ESP_WML_LOGERROR(F("HTML: Error can't alloc spans"));
+        clearHTMLSlots();
+        return false;
+      }
+
+      char*       spanStart = _htmlBuffer;
+      const char* titleMark = strstr(_htmlBuffer, title);
+      const char* marker;
+      const char* markerEnd;
+
+      while (_numHtmlSpans < maxSpans - 1)
+      {
+        const int16_t slot = findHTMLSlot(spanStart, titleMark, marker, markerEnd);
+
+        if (slot == WM_HTML_SLOT_NONE)
+          break;
+
+        // Cut off the literal at the marker
+        _htmlBuffer[marker - _htmlBuffer] = 0;
+
+        _htmlSpans[_numHtmlSpans].text   = spanStart;
+        _htmlSpans[_numHtmlSpans].length = marker - spanStart;
+        _htmlSpans[_numHtmlSpans].slot   = slot;
+
+        _htmlLiteralsLength += _htmlSpans[_numHtmlSpans].length;
+        _numHtmlSpans++;
+
+        spanStart = _htmlBuffer + (markerEnd - _htmlBuffer);
+      }
+
+      // Trailing literal
+      _htmlSpans[_numHtmlSpans].text   = spanStart;
+      _htmlSpans[_numHtmlSpans].length = strlen(spanStart);
+      _htmlSpans[_numHtmlSpans].slot   = WM_HTML_SLOT_NONE;
+
+      _htmlLiteralsLength += _htmlSpans[_numHtmlSpans].length;
+      _numHtmlSpans++;
+
+      ESP_WML_LOGDEBUG3(F("HTML: spans="), _numHtmlSpans, F(", literals sz="), _htmlLiteralsLength);
+
+      return true;
+    }
+
+    //////////////////////////////////////////////
+
+    const char* getHTMLSlotValue(const int16_t& slot)
+    {
+      switch (slot)
+      {
+        case WM_HTML_SLOT_TITLE:
+
+          if ( RFC952_hostname[0] != 0 )
+          {
+            // Replace only if Hostname is valid
+            return RFC952_hostname;
+          }
+          else if ( ESP_WM_LITE_config.board_name[0] != 0 )
+          {
+            // Or replace only if board_name is valid.  Otherwise, keep intact
+            return ESP_WM_LITE_config.board_name;
+          }
+
+          return "ESP_ASYNC_WM_LITE";
+
+        case WM_HTML_SLOT_NM:
+          return hadConfigData ? ESP_WM_LITE_config.board_name : "";
+
+        default:
+
+          if ( (slot >= WM_HTML_SLOT_CREDS) && (slot < WM_HTML_SLOT_MENU_ITEM) )
+          {
+            const WiFi_Credentials& creds = ESP_WM_LITE_config.WiFi_Creds[(slot - WM_HTML_SLOT_CREDS) / 2];
+
+            if (!hadConfigData)
+              return "";
+
+            return ( (slot - WM_HTML_SLOT_CREDS) & 1 ) ? creds.wifi_pw : creds.wifi_ssid;
+          }
+
+#if USE_DYNAMIC_PARAMETERS
+          if ( (slot >= WM_HTML_SLOT_MENU_ITEM) && (slot < WM_HTML_SLOT_MENU_ITEM + NUM_MENU_ITEMS) )
+            return myMenuItems[slot - WM_HTML_SLOT_MENU_ITEM].pdata;
+#endif
+
+          return "";
+      }
+    }
+
+    //////////////////////////////////////////////
+
+    // Fill all slots of the parsed template in one pass, into a buffer sized exactly once
+    void renderHTML(String& result)
+    {
+      if ( !_htmlSpans && !buildHTMLSlots() )
+      {
+        result = "";
+        return;
+      }
+
+      size_t totalLength = _htmlLiteralsLength;
+
+      for (uint16_t i = 0; i < _numHtmlSpans; i++)
+      {
+        if (_htmlSpans[i].slot != WM_HTML_SLOT_NONE)
+          totalLength += strlen(getHTMLSlotValue(_htmlSpans[i].slot));
+      }
+
+      result = "";
+      result.reserve(totalLength);
+
+      for (uint16_t i = 0; i < _numHtmlSpans; i++)
+      {
+        result += _htmlSpans[i].text;
+
+        if (_htmlSpans[i].slot != WM_HTML_SLOT_NONE)
+          result += getHTMLSlotValue(_htmlSpans[i].slot);
+      }
+    }
+
+    //////////////////////////////////////////////
+
+#define FNV1A_32_INIT       ( (uint32_t) 0x811C9DC5 )
+#define FNV1A_32_PRIME      ( (uint32_t) 0x01000193 )
+
+    uint32_t hashBytes(const void* data, const size_t& len, uint32_t hash = FNV1A_32_INIT)
+    {
+      const uint8_t* bytes = (const uint8_t*) data;
+
+      for (size_t i = 0; i < len; i++)
+      {
+        hash = (hash ^ bytes[i]) * FNV1A_32_PRIME;
+      }
+
+      return hash;
+    }
+
+    //////////////////////////////////////////////
+
+#if USING_HTML_CACHE
+
+    // Hash of everything the slots are filled from. The template itself (and the SSID list) only
+    // changes through clearHTMLSlots(), which drops the cache
+    uint32_t getHTMLCacheKey()
+    {
+      uint32_t hash = hashBytes(&ESP_WM_LITE_config, sizeof(ESP_WM_LITE_config));
+
+      hash = hashBytes(&hadConfigData, sizeof(hadConfigData), hash);
+
+      // Page title
+      hash = hashBytes(RFC952_hostname, sizeof(RFC952_hostname), hash);
+
+#if USE_DYNAMIC_PARAMETERS
+
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      {
+        // With terminating NULL, to separate items
+        hash = hashBytes(myMenuItems[i].pdata, strlen(myMenuItems[i].pdata) + 1, hash);
+      }
+
+#endif
+
+      return hash;
+    }
+
+    //////////////////////////////////////////////
+
+    // Cached page if still valid for key, from getHTMLCacheKey(), else newly rendered one, with _htmlETag updated.
+    // nullptr if no memory
+    std::shared_ptr<String> getCachedHTML(const uint32_t& key)
+    {
+      if (_htmlCache && (key == _htmlCacheKey))
+      {
+        _htmlCacheHits++;
+
+        return _htmlCache;
+      }
+
+      _htmlCacheMisses++;
+
+      std::shared_ptr<String> page(new String());
+
+      if (!page)
+        return page;
+
+      renderHTML(*page);
+
+      snprintf(_htmlETag, sizeof(_htmlETag), "\"%08x\"", (unsigned int) hashBytes(page->c_str(), page->length()));
+      _htmlETagKey = key;
+
+      ESP_WML_LOGDEBUG3(F("h:Rendered, size="), page->length(), F(", ETag="), _htmlETag);
+
+      if (page->length() <= HTML_CACHE_MAX_SIZE)
+      {
+        _htmlCache    = page;
+        _htmlCacheKey = key;
+      }
+      else
+      {
+        _htmlCache.reset();
+      }
+
+      return page;
+    }
+
+#endif    // USING_HTML_CACHE
+
+    //////////////////////////////////////////////
+
+#if USING_CHUNKED_RESPONSE
+
+    // Fill the slots of one part of the page, in place
+    void fillHTMLSlots(String& html)
+    {
+      char title[sizeof(ESP_WM_LITE_HTML_TITLE_SLOT)];
+
+      strcpy_P(title, ESP_WM_LITE_HTML_TITLE_SLOT);
+
+      const char* text      = html.c_str();
+      const char* from      = text;
+      const char* titleMark = strstr(text, title);
+      const char* marker;
+      const char* markerEnd;
+
+      int16_t slot = findHTMLSlot(from, titleMark, marker, markerEnd);
+
+      if (slot == WM_HTML_SLOT_NONE)
+        return;
+
+      String result;
+
+      result.reserve(html.length());
+
+      do
+      {
+        result += html.substring(from - text, marker - text);
+        result += getHTMLSlotValue(slot);
+
+        from = markerEnd;
+      } while ( (slot = findHTMLSlot(from, titleMark, marker, markerEnd)) != WM_HTML_SLOT_NONE );
+
+      result += from;
+
+      html = result;
+    }
+
+    //////////////////////////////////////////////
+
+    // Copy the next bytes of the page into buffer, rendering it one part at a time. Return 0 when done
+    size_t fillHTMLChunk(ESP_WM_LITE_HTML_Cursor& cursor, uint8_t* buffer, const size_t& maxLen)
+    {
+      size_t filled = 0;
+
+      while (filled < maxLen)
+      {
+        if (cursor.offset >= cursor.html.length())
+        {
+          if (!createHTMLPart(cursor.part, cursor.html, cursor.scanning))
+            break;
+
+          fillHTMLSlots(cursor.html);
+
+          cursor.part++;
+          cursor.offset = 0;
+
+          continue;
+        }
+
+        size_t toCopy = cursor.html.length() - cursor.offset;
+
+        if (toCopy > maxLen - filled)
+          toCopy = maxLen - filled;
+
+        memcpy(buffer + filled, cursor.html.c_str() + cursor.offset, toCopy);
+
+        filled        += toCopy;
+        cursor.offset += toCopy;
+      }
+
+      return filled;
+    }
+
+    //////////////////////////////////////////////
+
+    // Chunked response streaming the page as the TCP window allows. Each request only keeps a cursor with the
+    // part being sent, so RAM doesn't grow with the number of clients, WiFi_Creds or MenuItems. A part is
+    // rendered whole under the portal lock, so a scan or save while streaming never cuts the page short
+    AsyncWebServerResponse* beginChunkedHTMLResponse(AsyncWebServerRequest *request)
+    {
+      std::shared_ptr<ESP_WM_LITE_HTML_Cursor> cursor(new ESP_WM_LITE_HTML_Cursor());
+
+      if (!cursor)
+        return nullptr;
+
+      cursor->part   = 0;
+      cursor->offset = 0;
+
+#if ( USING_ASYNC_WIFI_SCAN && !USING_SCAN_CACHE )
+      cursor->scanning = _scanRunning;
+#else
+      cursor->scanning = false;
+#endif
+
+      return request->beginChunkedResponse(FPSTR(WM_HTTP_HEAD_TEXT_HTML),
+                                           [this, cursor](uint8_t* buffer, size_t maxLen, size_t index) -> size_t
+      {
+        (void) index;
+
+        ESP_WM_LITE_LOCK_PORTAL();
+
+        return fillHTMLChunk(*cursor, buffer, maxLen);
+      });
+    }
+
+#endif    // USING_CHUNKED_RESPONSE
+
+    //////////////////////////////////////////////
+
+#if USING_GZIPPED_ASSETS
+
+    // Static asset : gzipped if the client accepts it, else plain. Long cache lifetime, as the URL carries the version
+    void handleAsset(AsyncWebServerRequest *request, PGM_P contentType, PGM_P plain, const uint8_t* gzipped,
+                     const size_t& gzippedLen, PGM_P etag, PGM_P gzippedETag)
+    {
+      if (!request)
+        return;
+
+      // Representation first, as each one has its own ETag
+      AsyncWebHeader* header = request->getHeader(FPSTR(WM_HTTP_ACCEPT_ENCODING));
+
+      const bool useGzip = header && (header->value().indexOf(String(FPSTR(WM_HTTP_GZIP))) >= 0);
+
+      if (useGzip)
+        etag = gzippedETag;
+
+      AsyncWebServerResponse *response;
+
+      header = request->getHeader(FPSTR(WM_HTTP_IF_NONE_MATCH));
+
+      if ( header && (header->value() == String(FPSTR(etag))) )
+      {
+        ESP_WML_LOGDEBUG1(F("Asset not modified:"), request->url());
+        response = request->beginResponse(304);
+      }
+      else if (useGzip)
+      {
+        response = request->beginResponse_P(200, FPSTR(contentType), gzipped, gzippedLen);
+        response->addHeader(FPSTR(WM_HTTP_CONTENT_ENCODING), FPSTR(WM_HTTP_GZIP));
+      }
+      else
+      {
+        response = request->beginResponse_P(200, FPSTR(contentType), plain);
+      }
+
+      response->addHeader(FPSTR(WM_HTTP_VARY), FPSTR(WM_HTTP_ACCEPT_ENCODING));
+      response->addHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_CACHE_LONG));
+      response->addHeader(FPSTR(WM_HTTP_ETAG), FPSTR(etag));
+
+      request->send(response);
+    }
+
+#endif
+
+    //////////////////////////////////////////////
+
+#if USING_CAPTIVE_PROBE_ROUTES
+
+    void handleProbe(AsyncWebServerRequest *request, const uint8_t& route)
+    {
+      if (!request)
+        return;
+
+      _probeHits[route]++;
+
+      ESP_WML_LOGDEBUG1(F("h:Probe "), request->url());
+
+      if (ESP_WM_LITE_PROBE_ROUTES[route].code == 302)
+        request->redirect(_portalURL);
+      else
+        request->send(ESP_WM_LITE_PROBE_ROUTES[route].code);
+    }
+
+#endif
+
+    //////////////////////////////////////////////
+
+    void handleRequest(AsyncWebServerRequest *request)
+    {
+      if (request)
+      {
+        String key = request->arg("key");
+        String value = request->arg("value");
+
+        if (key == "" && value == "")
+        {
+          // Reset configTimeout to stay here until finished.
+          configTimeout = 0;
+
+#if USING_CHUNKED_RESPONSE
+
+          // Stream the page piece by piece, without materializing it in a String
+          AsyncWebServerResponse *response = beginChunkedHTMLResponse(request);
+
+          if (!response)
+          {
+            request->send(500, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "No memory");
+            return;
+          }
+
+#elif USING_HTML_CACHE
+
+          std::shared_ptr<String> page;
+          char etag[sizeof(_htmlETag)];
+          bool notModified;
+
+          AsyncWebHeader* header = request->getHeader(FPSTR(WM_HTTP_IF_NONE_MATCH));
+
+          {
+            ESP_WM_LITE_LOCK_PORTAL();
+
+            const uint32_t key = getHTMLCacheKey();
+
+            // Checked before rendering : the page the browser has may be from the same data
+            notModified = header && (_htmlETag[0] != 0) && (key == _htmlETagKey) && (header->value() == _htmlETag);
+
+            if (!notModified)
+            {
+              page = getCachedHTML(key);
+
+              // Template rebuilt since, or other data : the new page may still be the same
+              notModified = page && header && (header->value() == _htmlETag);
+            }
+
+            strcpy(etag, _htmlETag);
+          }
+
+          if (notModified)
+          {
+            ESP_WML_LOGDEBUG(F("h:HTML not modified"));
+
+            AsyncWebServerResponse *response = request->beginResponse(304);
+
+            response->addHeader(FPSTR(WM_HTTP_ETAG), etag);
+            response->addHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_CACHE));
+
+            request->send(response);
+            return;
+          }
+
+          if (!page)
+          {
+            request->send(500, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "No memory");
+            return;
+          }
+
+#else
+
+          String result;
+
+          {
+            ESP_WM_LITE_LOCK_PORTAL();
+
+            renderHTML(result);
+          }
+
+          ESP_WML_LOGDEBUG1(F("h:HTML page size:"), result.length());
+          ESP_WML_LOGDEBUG1(F("h:HTML="), result);
+
+#endif
+
+#if USING_HTML_CACHE
+
+#if ( ARDUINO_ESP32S2_DEV || ARDUINO_FEATHERS2 || ARDUINO_PROS2 || ARDUINO_MICROS2 )
+          AsyncWebServerResponse *response = request->beginResponse(200, FPSTR(WM_HTTP_HEAD_TEXT_HTML), *page);
+#else
+          // Send from the shared page, without copying it. The page stays alive until sent, even if the cache drops it
+          AsyncWebServerResponse *response = request->beginResponse(FPSTR(WM_HTTP_HEAD_TEXT_HTML), page->length(),
+                                             [page](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+          {
+            const size_t len = std::min(maxLen, page->length() - index);
+
+            memcpy(buffer, page->c_str() + index, len);
+
+            return len;
+          });
+#endif
+
+          // Browser can keep the page, but has to revalidate it with If-None-Match
+          response->addHeader(FPSTR(WM_HTTP_ETAG), etag);
+          response->addHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_CACHE));
+
+#else
+
+#if !USING_CHUNKED_RESPONSE
+          AsyncWebServerResponse *response = request->beginResponse(200, FPSTR(WM_HTTP_HEAD_TEXT_HTML), result);
+#endif
+
+          response->addHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+
+#endif    // USING_HTML_CACHE
+
+#if USING_CORS_FEATURE
+          // New from v1.2.0, for configure CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
+          ESP_WML_LOGDEBUG3(F("handleRequest:WM_HTTP_CORS:"), WM_HTTP_CORS, " : ", _CORS_Header);
+          response->addHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
+
+          response->addHeader(FPSTR(WM_HTTP_PRAGMA), FPSTR(WM_HTTP_NO_CACHE));
+          response->addHeader(FPSTR(WM_HTTP_EXPIRES), "-1");
+
+          request->send(response);
+
+#if ( ARDUINO_ESP32S2_DEV || ARDUINO_FEATHERS2 || ARDUINO_PROS2 || ARDUINO_MICROS2 ) && !USING_CHUNKED_RESPONSE
+          // Fix ESP32-S2 issue with WebServer (https://github.com/espressif/arduino-esp32/issues/4348)
+          delay(1);
+#endif
+
+          return;
+        }
+
+        // The staged Config Data is also taken over by applyConfig(), from run()
+        ESP_WM_LITE_LOCK_PORTAL();
+
+#if USING_HOT_APPLY
+
+        if ( (_itemsUpdated == 0) && !stageConfig() )
+        {
+          request->send(503, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "Busy");
+          return;
+        }
+
+#endif
+
+        ESP_WM_LITE_Configuration& config = portalConfig();
+
+        if (_itemsUpdated == 0)
+        {
+          memset(&config, 0, sizeof(config));
+          strcpy(config.header, ESP_WM_LITE_BOARD_TYPE);
+        }
+
+#if USE_DYNAMIC_PARAMETERS
+
+        if (!menuItemUpdated)
+        {
+          // Don't need to free
+          menuItemUpdated = new bool[NUM_MENU_ITEMS];
+
+          if (menuItemUpdated)
+          {
+            for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+            {
+              // To flag item is not yet updated
+              menuItemUpdated[i] = false;
+            }
+
+            ESP_WML_LOGDEBUG(F("h: Init menuItemUpdated" ));
+          }
+          else
+          {
+            ESP_WML_LOGERROR(F("h: Error can't alloc memory for menuItemUpdated" ));
+          }
+        }
+
+#endif
+
+#if USE_DYNAMIC_PARAMETERS
+        bool isConfigItem = false;
+#endif
+
+        for (uint16_t i = 0; i < NUM_CONFIGURABLE_ITEMS; i++)
+        {
+          String  itemKey;
+          size_t  itemSize;
+          char*   item = getConfigItem(i, itemSize, itemKey);
+
+          if (!_configItemUpdated[i] && (key == itemKey))
+          {
+            ESP_WML_LOGDEBUG1(F("h:repl "), itemKey);
+            _configItemUpdated[i] = true;
+
+#if USE_DYNAMIC_PARAMETERS
+            isConfigItem   = true;
+#endif
+
+            _itemsUpdated++;
+
+            if (strlen(value.c_str()) < itemSize - 1)
+              strcpy(item, value.c_str());
+            else
+              strncpy(item, value.c_str(), itemSize - 1);
+
+            break;
+          }
+        }
+
+#if USE_DYNAMIC_PARAMETERS
+
+        if (!isConfigItem)
+        {
+          for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+          {
+            if ( !menuItemUpdated[i] && (key == myMenuItems[i].id) )
+            {
+              ESP_WML_LOGDEBUG3(F("h:"), myMenuItems[i].id, F("="), value.c_str() );
+
+              menuItemUpdated[i] = true;
+
+              _itemsUpdated++;
+
+              char* data = portalMenuData(i);
+
+              // Actual size of pdata is [maxlen + 1]
+              memset(data, 0, myMenuItems[i].maxlen + 1);
+
+              if ((int) strlen(value.c_str()) < myMenuItems[i].maxlen)
+                strcpy(data, value.c_str());
+              else
+                strncpy(data, value.c_str(), myMenuItems[i].maxlen);
+
+              break;
+            }
+          }
+        }
+
+#endif
+
+        ESP_WML_LOGDEBUG1(F("h:items updated ="), _itemsUpdated);
+        ESP_WML_LOGDEBUG3(F("h:key ="), key, ", value =", value);
+
+        request->send(200, FPSTR(WM_HTTP_HEAD_TEXT_HTML), "OK");
+
+#if USE_DYNAMIC_PARAMETERS
+
+        if (_itemsUpdated == NUM_CONFIGURABLE_ITEMS + NUM_MENU_ITEMS)
+#else
+        if (_itemsUpdated == NUM_CONFIGURABLE_ITEMS)
+#endif
+        {
+          saveConfigAndApply();
+        }
+      }   // if (server)
+    }
+
+    //////////////////////////////////////////////
+
+    // handleRequest() to start again from the first field : after a save, and when the Config Portal is opened
+    void resetItemsUpdated()
+    {
+      _itemsUpdated = 0;
+      memset(_configItemUpdated, 0, sizeof(_configItemUpdated));
+
+#if USE_DYNAMIC_PARAMETERS
+
+      if (menuItemUpdated)
+        memset(menuItemUpdated, 0, NUM_MENU_ITEMS * sizeof(bool));
+
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+    void savePortalConfig()
+    {
+#if USE_LITTLEFS
+      ESP_WML_LOGERROR1(F("h:Updating LittleFS:"), CONFIG_FILENAME);
+#elif USE_SPIFFS
+      ESP_WML_LOGERROR1(F("h:Updating SPIFFS:"), CONFIG_FILENAME);
+#else
+      ESP_WML_LOGERROR(F("h:Updating EEPROM. Please wait for reset"));
+#endif
+
+      saveAllConfigData();
+
+      // Done with CP, Clear CP Flag here if forced
+      if (isForcedConfigPortal)
+        clearForcedCP();
+    }
+
+    //////////////////////////////////////////////
+
+    void saveConfigAndApply()
+    {
+      resetItemsUpdated();
+
+#if USING_HOT_APPLY
+      // Saved and applied by applyConfig() from run() : not from the web server's task, and only once the reply to
+      // this save is sent, as the portal is closed
+      _applyTime    = millis();
+      _applyPending = true;
+#else
+      savePortalConfig();
+
+      ESP_WML_LOGERROR(F("h:Rst"));
+
+      // TO DO : what command to reset
+      // Delay then reset the board after save data
+      resetFunc();
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+#if USING_HOT_APPLY
+
+    // Data in use, compared by applyConfig() with the next saved one
+    void saveAppliedConfig()
+    {
+      memcpy(_appliedCreds, ESP_WM_LITE_config.WiFi_Creds, sizeof(_appliedCreds));
+
+#if USE_DYNAMIC_PARAMETERS
+
+      if (!_menuItemHashes)
+        _menuItemHashes = new uint32_t[NUM_MENU_ITEMS];
+
+      if (_menuItemHashes)
+      {
+        for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+          _menuItemHashes[i] = hashBytes(myMenuItems[i].pdata, strlen(myMenuItems[i].pdata));
+      }
+
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+    // Saved from the Config Portal : close it, tell the app of changed MenuItems, and reconnect WiFi with the new
+    // credentials if changed, without reset
+    void applyConfig()
+    {
+      ESP_WML_LOGINFO(F("Apply config"));
+
+      stopConfigurationMode();
+
+      bool nameChanged;
+
       {
-        status = WiFi.status();
+        // A new stage can't start before this is taken over
+        ESP_WM_LITE_LOCK_PORTAL();
 
-        if ( status == WL_CONNECTED )
-          break;
-        else
-          delay(WIFI_MULTI_CONNECT_WAITING_MS);
+        nameChanged = strcmp(_stagedConfig.board_name, ESP_WM_LITE_config.board_name);
+
+        memcpy(&ESP_WM_LITE_config, &_stagedConfig, sizeof(ESP_WM_LITE_config));
+
+#if USE_DYNAMIC_PARAMETERS
+
+        for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+          memcpy(myMenuItems[i].pdata, portalMenuData(i), myMenuItems[i].maxlen + 1);
+
+#endif
+
+        _applyPending = false;
       }
 
-      if ( status == WL_CONNECTED )
+      savePortalConfig();
+
+      hadConfigData = true;
+
+      // No callback, getBoardName() returns the new one from now on
+      if (nameChanged)
+        ESP_WML_LOGINFO1(F("Changed:"), "nm");
+
+      bool needReset = false;
+
+#if USE_DYNAMIC_PARAMETERS
+
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
       {
-        ESP_WML_LOGWARN1(F("WiFi connected after time: "), i);
-        ESP_WML_LOGWARN3(F("SSID="), WiFi.SSID(), F(",RSSI="), WiFi.RSSI());
-        ESP_WML_LOGWARN3(F("Channel="), WiFi.channel(), F(",IP="), WiFi.localIP() );
+        const uint32_t hash = hashBytes(myMenuItems[i].pdata, strlen(myMenuItems[i].pdata));
+
+        if (_menuItemHashes && (_menuItemHashes[i] == hash))
+          continue;
+
+        ESP_WML_LOGINFO1(F("Changed:"), myMenuItems[i].id);
+
+        // Unknown to the app without callback
+        if ( !_menuItemChangeCallback || _menuItemChangeCallback(i) )
+          needReset = true;
       }
-      else
+
+#endif
+
+      if (needReset)
       {
-        ESP_WML_LOGERROR(F("WiFi not connected"));
+        ESP_WML_LOGERROR(F("h:Rst"));
+        resetFunc();
 
-#if RESET_IF_NO_WIFI
+        return;
+      }
 
-#if USING_MRD
-        // To avoid unnecessary MRD
-        mrd->loop();
+      bool credsChanged = false;
+
+      for (uint8_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
+      {
+        if ( strcmp(_appliedCreds[i].wifi_ssid, ESP_WM_LITE_config.WiFi_Creds[i].wifi_ssid) ||
+             strcmp(_appliedCreds[i].wifi_pw, ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw) )
+        {
+          credsChanged = true;
+
+#if USING_CREDS_RANKING
+          // Were of the previous credentials
+          memset(&_credsStats[i], 0, sizeof(_credsStats[i]));
+#endif
+        }
+      }
+
+      saveAppliedConfig();
+
+      // The STA is down under the Config Portal without USING_AP_STA_PORTAL
+      if ( !credsChanged && (getWiFiLinkStatus() == WL_CONNECTED) )
+      {
+        ESP_WML_LOGINFO(F("WiFi unchanged"));
+        return;
+      }
+
+      // No API to remove the old credentials
+#ifdef ESP8266
+      wifiMulti.~ESP8266WiFiMulti();
+      new (&wifiMulti) ESP8266WiFiMulti();
 #else
-        // To avoid unnecessary DRD
-        drd->loop();
+      wifiMulti.~WiFiMulti();
+      new (&wifiMulti) WiFiMulti();
 #endif
 
-        resetFunc();
+      addWiFiMultiAPs();
+
+      WiFi.disconnect();
+      wifi_connected = false;
+
+#if USING_NONBLOCKING_CONNECT
+      startConnectAttempt(0);
+#else
+      connectMultiWiFi();
+#endif
+    }
+
+    //////////////////////////////////////////////
+
+#endif
+
+    //////////////////////////////////////////////
+
+    // Config Data written by the Config Portal's handlers. With USING_HOT_APPLY, a staged copy : the app keeps
+    // reading the data in use from its loop until applyConfig() takes the new one over
+    ESP_WM_LITE_Configuration& portalConfig()
+    {
+#if USING_HOT_APPLY
+      return _stagedConfig;
+#else
+      return ESP_WM_LITE_config;
+#endif
+    }
+
+#if USE_DYNAMIC_PARAMETERS
+
+    // Same for the data of MenuItem i, [maxlen + 1] bytes
+    char* portalMenuData(const uint16_t& i)
+    {
+#if USING_HOT_APPLY
+      char* data = _stagedMenuData;
+
+      for (uint16_t j = 0; j < i; j++)
+        data += myMenuItems[j].maxlen + 1;
+
+      return data;
+#else
+      return myMenuItems[i].pdata;
+#endif
+    }
 
 #endif
+
+    //////////////////////////////////////////////
+
+#if USING_HOT_APPLY
+
+    // Start the staged copy from the data in use, under the portal lock. false while the last save isn't applied yet
+    bool stageConfig()
+    {
+      if (_applyPending)
+        return false;
+
+      memcpy(&_stagedConfig, &ESP_WM_LITE_config, sizeof(_stagedConfig));
+
+#if USE_DYNAMIC_PARAMETERS
+
+      if (!_stagedMenuData)
+      {
+        size_t size = 0;
+
+        for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+          size += myMenuItems[i].maxlen + 1;
+
+        _stagedMenuData = (char*) malloc(size);
+
+        if (!_stagedMenuData)
+        {
+          ESP_WML_LOGERROR(F("h: Error can't alloc memory for staged data" ));
+          return false;
+        }
       }
 
-      return status;
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+        memcpy(portalMenuData(i), myMenuItems[i].pdata, myMenuItems[i].maxlen + 1);
+
+#endif
+
+      return true;
     }
 
+#endif
+
     //////////////////////////////////////////////
 
-    // NEW
-    void createHTML(String& root_html_template)
+    // Configurable item : SSID then PWD of each WiFi_Creds[], then board_name. Returns the field, its size and form id
+    char* getConfigItem(const uint16_t& item, size_t& size, String& key)
     {
-      String pitem;
+      ESP_WM_LITE_Configuration& config = portalConfig();
 
-      root_html_template = FPSTR(ESP_WM_LITE_HTML_HEAD_START);
+      if (item < 2 * NUM_WIFI_CREDENTIALS)
+      {
+        WiFi_Credentials& creds = config.WiFi_Creds[item / 2];
 
-#if USING_CUSTOMS_STYLE
+        // "id" / "pw" for WiFi_Creds[0], then "id1" / "pw1"...
+        key = (item & 1) ? "pw" : "id";
 
-      // Using Customs style when not NULL
-      if (_CustomsHeadStyle)
-        root_html_template += FPSTR(_CustomsHeadStyle);
-      else
-        root_html_template += FPSTR(ESP_WM_LITE_HTML_HEAD_STYLE);
+        if (item >= 2)
+          key += item / 2;
+
+        size = (item & 1) ? sizeof(creds.wifi_pw) : sizeof(creds.wifi_ssid);
+
+        return (item & 1) ? creds.wifi_pw : creds.wifi_ssid;
+      }
+
+      key   = "nm";
+      size  = sizeof(config.board_name);
+
+      return config.board_name;
+    }
+
+    //////////////////////////////////////////////
+
+    // Copy value, truncated to fit, into a field of destSize bytes including the terminating NUL
+    void copyConfigValue(char* dest, const size_t& destSize, const char* value)
+    {
+      memset(dest, 0, destSize);
+      strncpy(dest, value, destSize - 1);
+    }
+
+    void copyConfigValue(char* dest, const size_t& destSize, const String& value)
+    {
+      copyConfigValue(dest, destSize, value.c_str());
+    }
+
+    //////////////////////////////////////////////
+
+    // POST ESP_WM_LITE_SAVE_URL, form-encoded : all fields in one request. Either all are applied and saved once,
+    // or nothing is changed if any field is missing
+    void handleSave(AsyncWebServerRequest *request)
+    {
+      if (!request)
+        return;
+
+      String  keys  [NUM_CONFIGURABLE_ITEMS];
+      char*   fields[NUM_CONFIGURABLE_ITEMS];
+      size_t  sizes [NUM_CONFIGURABLE_ITEMS];
+
+      for (uint16_t i = 0; i < NUM_CONFIGURABLE_ITEMS; i++)
+      {
+        fields[i] = getConfigItem(i, sizes[i], keys[i]);
+      }
+
+      // Check first, apply later
+      for (uint16_t i = 0; i < NUM_CONFIGURABLE_ITEMS; i++)
+      {
+        if (!request->hasParam(keys[i], true))
+        {
+          ESP_WML_LOGERROR1(F("s:Missing"), keys[i]);
+          request->send(400, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), String("Missing ") + keys[i]);
+          return;
+        }
+      }
+
+#if USE_DYNAMIC_PARAMETERS
+
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      {
+        if (!request->hasParam(myMenuItems[i].id, true))
+        {
+          ESP_WML_LOGERROR1(F("s:Missing"), myMenuItems[i].id);
+          request->send(400, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), String("Missing ") + myMenuItems[i].id);
+          return;
+        }
+      }
 
-#else
-      root_html_template += FPSTR(ESP_WM_LITE_HTML_HEAD_STYLE);
 #endif
 
-#if USING_CUSTOMS_HEAD_ELEMENT
+      ESP_WM_LITE_LOCK_PORTAL();
+
+#if USING_HOT_APPLY
 
-      if (_CustomsHeadElement)
-        root_html_template += _CustomsHeadElement;
+      if (!stageConfig())
+      {
+        request->send(503, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "Busy");
+        return;
+      }
 
 #endif
 
-#if SCAN_WIFI_NETWORKS
+      ESP_WM_LITE_Configuration& config = portalConfig();
 
-      ESP_WML_LOGDEBUG1(WiFiNetworksFound, F(" SSIDs found, generating HTML now"));
-      // Replace HTML <input...> with <select...>, based on WiFi network scan in startConfigurationMode()
+      memset(&config, 0, sizeof(config));
+      strcpy(config.header, ESP_WM_LITE_BOARD_TYPE);
+
+      for (uint16_t i = 0; i < NUM_CONFIGURABLE_ITEMS; i++)
+      {
+        copyConfigValue(fields[i], sizes[i], request->getParam(keys[i], true)->value());
+      }
 
-      ListOfSSIDs = "";
+#if USE_DYNAMIC_PARAMETERS
 
-      for (int i = 0, list_items = 0; (i < WiFiNetworksFound) && (list_items < MAX_SSID_IN_LIST); i++)
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
       {
-        if (indices[i] == -1)
-          continue;     // skip duplicates and those that are below the required quality
+        // Actual size of pdata is [maxlen + 1]
+        copyConfigValue(portalMenuData(i), myMenuItems[i].maxlen + 1, request->getParam(myMenuItems[i].id, true)->value());
+
+        ESP_WML_LOGDEBUG3(F("s:"), myMenuItems[i].id, F("="), portalMenuData(i));
+      }
+
+#endif
+
+      request->send(200, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "OK");
+
+      saveConfigAndApply();
+    }
+
+    //////////////////////////////////////////////
+
+#if (USING_CONFIG_API || USING_SCAN_CACHE)
+
+    // Write s as a JSON string, escaping only what has to be
+    void printJSONString(Print& out, const char* s)
+    {
+      out.print('"');
+
+      const char* run = s;
+
+      for ( ; *s; s++)
+      {
+        const uint8_t c = (uint8_t) *s;
+
+        if ( (c >= 0x20) && (c != '"') && (c != '\\') )
+          continue;
+
+        out.write(run, s - run);
+
+        if ( (c == '"') || (c == '\\') )
+        {
+          out.print('\\');
+          out.print((char) c);
+        }
+        else
+        {
+          char hex[7];
+
+          snprintf(hex, sizeof(hex), "\\u%04x", c);
+          out.print(hex);
+        }
+
+        run = s + 1;
+      }
+
+      out.write(run, s - run);
+      out.print('"');
+    }
+
+#endif
+
+    //////////////////////////////////////////////
+
+#if USING_CONFIG_API
+
+    // GET ESP_WM_LITE_CONFIG_API_URL. Printed field by field into the response, no intermediate document
+    void handleConfigAPIGet(AsyncWebServerRequest *request)
+    {
+      if (!request)
+        return;
+
+      AsyncResponseStream *response = request->beginResponseStream(FPSTR(WM_HTTP_HEAD_JSON));
+
+      response->print(F("{\"WiFi_Creds\":["));
+
+      for (uint8_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
+      {
+        if (i)
+          response->print(',');
+
+        response->print(F("{\"wifi_ssid\":"));
+        printJSONString(*response, hadConfigData ? ESP_WM_LITE_config.WiFi_Creds[i].wifi_ssid : "");
+        response->print(F(",\"wifi_pw\":"));
+        printJSONString(*response, hadConfigData ? ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw : "");
+        response->print('}');
+      }
+
+      response->print(F("],\"board_name\":"));
+      printJSONString(*response, hadConfigData ? ESP_WM_LITE_config.board_name : "");
+
+#if USE_DYNAMIC_PARAMETERS
+
+      response->print(F(",\"menu\":{"));
+
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      {
+        if (i)
+          response->print(',');
+
+        printJSONString(*response, myMenuItems[i].id);
+        response->print(':');
+        printJSONString(*response, myMenuItems[i].pdata);
+      }
+
+      response->print('}');
+
+#endif
+
+      response->print('}');
+
+      response->addHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+
+#if USING_CORS_FEATURE
+      response->addHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
+#endif
+
+      request->send(response);
+    }
+
+    //////////////////////////////////////////////
+
+    // Collect the PUT body, possibly in several pieces, into request->_tempObject (freed with the request)
+    void handleConfigAPIBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+    {
+      if ( !request || (total > CONFIG_API_MAX_BODY_SIZE) )
+        return;
+
+      if (index == 0)
+      {
+        request->_tempObject = calloc(total + 1, 1);
+      }
+
+      if ( request->_tempObject && (index + len <= total) )
+      {
+        memcpy((char*) request->_tempObject + index, data, len);
+      }
+    }
+
+    //////////////////////////////////////////////
+
+    char* skipJSONSpaces(char* p)
+    {
+      while ( (*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n') )
+        p++;
+
+      return p;
+    }
+
+    //////////////////////////////////////////////
 
-        ListOfSSIDs += String(FPSTR(ESP_WM_LITE_OPTION_START)) + String(WiFi.SSID(indices[i])) + String(FPSTR(ESP_WM_LITE_OPTION_END));
-        list_items++;   // Count number of suitable, distinct SSIDs to be included in list
-      }
+    // Decode the JSON string at p in place, as the decoded text is never longer than the escaped one.
+    // Return its NULL-terminated start and move p past the closing quote, or nullptr if invalid
+    char* parseJSONString(char*& p)
+    {
+      p = skipJSONSpaces(p);
 
-      ESP_WML_LOGDEBUG(ListOfSSIDs);
+      if (*p != '"')
+        return nullptr;
 
-      if (ListOfSSIDs == "")    // No SSID found or none was good enough
-        ListOfSSIDs = String(FPSTR(ESP_WM_LITE_OPTION_START)) + String(FPSTR(ESP_WM_LITE_NO_NETWORKS_FOUND)) + String(FPSTR(ESP_WM_LITE_OPTION_END));
+      char* start = ++p;
+      char* out   = start;
 
-      pitem = String(FPSTR(ESP_WM_LITE_HTML_HEAD_END));
+      while (*p != '"')
+      {
+        if ( (uint8_t) *p < 0x20 )
+          return nullptr;
 
-#if MANUAL_SSID_INPUT_ALLOWED
-      pitem.replace("[[input_id]]",  "<input id='id' list='SSIDs'>"  + String(FPSTR(ESP_WM_LITE_DATALIST_START)) + "'SSIDs'>" +
-                    ListOfSSIDs + FPSTR(ESP_WM_LITE_DATALIST_END));
-      ESP_WML_LOGDEBUG1(F("pitem:"), pitem);
-      pitem.replace("[[input_id1]]", "<input id='id1' list='SSIDs'>" + String(FPSTR(ESP_WM_LITE_DATALIST_START)) + "'SSIDs'>" +
-                    ListOfSSIDs + FPSTR(ESP_WM_LITE_DATALIST_END));
-      ESP_WML_LOGDEBUG1(F("pitem:"), pitem);
-#else
-      pitem.replace("[[input_id]]",  "<select id='id'>"  + ListOfSSIDs + FPSTR(ESP_WM_LITE_SELECT_END));
-      pitem.replace("[[input_id1]]", "<select id='id1'>" + ListOfSSIDs + FPSTR(ESP_WM_LITE_SELECT_END));
-#endif
+        if (*p != '\\')
+        {
+          *out++ = *p++;
+          continue;
+        }
 
-      root_html_template += pitem + FPSTR(ESP_WM_LITE_FLDSET_START);
+        p++;
 
-#else
+        switch (*p)
+        {
+          case '"':
+          case '\\':
+          case '/':
+            *out++ = *p;
+            break;
 
-      pitem = String(FPSTR(ESP_WM_LITE_HTML_HEAD_END));
-      pitem.replace("[[input_id]]",  FPSTR(ESP_WM_LITE_HTML_INPUT_ID));
-      pitem.replace("[[input_id1]]", FPSTR(ESP_WM_LITE_HTML_INPUT_ID1));
-      root_html_template += pitem + FPSTR(ESP_WM_LITE_FLDSET_START);
+          case 'b':
+            *out++ = '\b';
+            break;
 
-#endif    // SCAN_WIFI_NETWORKS
+          case 'f':
+            *out++ = '\f';
+            break;
 
-#if USE_DYNAMIC_PARAMETERS
+          case 'n':
+            *out++ = '\n';
+            break;
 
-      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
-      {
-        pitem = String(FPSTR(ESP_WM_LITE_HTML_PARAM));
+          case 'r':
+            *out++ = '\r';
+            break;
 
-        pitem.replace("{b}", myMenuItems[i].displayName);
-        pitem.replace("{v}", myMenuItems[i].id);
-        pitem.replace("{i}", myMenuItems[i].id);
+          case 't':
+            *out++ = '\t';
+            break;
 
-        root_html_template += pitem;
-      }
+          case 'u':
+          {
+            uint16_t code = 0;
 
-#endif
+            for (uint8_t i = 1; i <= 4; i++)
+            {
+              const char c = p[i];
+
+              if ( (c >= '0') && (c <= '9') )
+                code = (code << 4) | (c - '0');
+              else if ( (c >= 'a') && (c <= 'f') )
+                code = (code << 4) | (c - 'a' + 10);
+              else if ( (c >= 'A') && (c <= 'F') )
+                code = (code << 4) | (c - 'A' + 10);
+              else
+                return nullptr;
+            }
 
-      root_html_template += String(FPSTR(ESP_WM_LITE_FLDSET_END)) + FPSTR(ESP_WM_LITE_HTML_BUTTON) + FPSTR(ESP_WM_LITE_HTML_SCRIPT);
+            p += 4;
 
-#if USE_DYNAMIC_PARAMETERS
+            // UTF-8. Surrogate pairs are kept as two 3-byte sequences
+            if (code < 0x80)
+            {
+              *out++ = (char) code;
+            }
+            else if (code < 0x800)
+            {
+              *out++ = (char) (0xC0 | (code >> 6));
+              *out++ = (char) (0x80 | (code & 0x3F));
+            }
+            else
+            {
+              *out++ = (char) (0xE0 | (code >> 12));
+              *out++ = (char) (0x80 | ((code >> 6) & 0x3F));
+              *out++ = (char) (0x80 | (code & 0x3F));
+            }
 
-      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
-      {
-        pitem = String(FPSTR(ESP_WM_LITE_HTML_SCRIPT_ITEM));
+            break;
+          }
 
-        pitem.replace("{d}", myMenuItems[i].id);
+          default:
+            return nullptr;
+        }
 
-        root_html_template += pitem;
+        p++;
       }
 
-#endif
-
-      root_html_template += String(FPSTR(ESP_WM_LITE_HTML_SCRIPT_END)) + FPSTR(ESP_WM_LITE_HTML_END);
+      p++;
+      *out = 0;
 
-      return;
+      return start;
     }
 
     //////////////////////////////////////////////
 
-    void handleRequest(AsyncWebServerRequest *request)
+    // Check the next structural char, and move past it
+    bool parseJSONChar(char*& p, const char& c)
     {
-      if (request)
-      {
-        String key = request->arg("key");
-        String value = request->arg("value");
+      p = skipJSONSpaces(p);
 
-        static int number_items_Updated = 0;
+      if (*p != c)
+        return false;
 
-        if (key == "" && value == "")
-        {
-          String result;
-          createHTML(result);
+      p++;
 
-          //ESP_WML_LOGDEBUG1(F("h:Repl:"), result);
+      return true;
+    }
 
-          // Reset configTimeout to stay here until finished.
-          configTimeout = 0;
+    //////////////////////////////////////////////
 
-          if ( RFC952_hostname[0] != 0 )
-          {
-            // Replace only if Hostname is valid
-            result.replace("ESP_ASYNC_WM_LITE", RFC952_hostname);
-          }
-          else if ( ESP_WM_LITE_config.board_name[0] != 0 )
-          {
-            // Or replace only if board_name is valid.  Otherwise, keep intact
-            result.replace("ESP_ASYNC_WM_LITE", ESP_WM_LITE_config.board_name);
-          }
+    // After a member or element : true and move past ',' if another one follows, else false
+    bool parseJSONNext(char*& p)
+    {
+      p = skipJSONSpaces(p);
 
-          if (hadConfigData)
-          {
-            result.replace("[[id]]",     ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid);
-            result.replace("[[pw]]",     ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw);
-            result.replace("[[id1]]",    ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid);
-            result.replace("[[pw1]]",    ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw);
+      if (*p != ',')
+        return false;
 
-#if USING_BOARD_NAME
-            result.replace("[[nm]]",     ESP_WM_LITE_config.board_name);
-#endif
-          }
-          else
-          {
-            result.replace("[[id]]",  "");
-            result.replace("[[pw]]",  "");
-            result.replace("[[id1]]", "");
-            result.replace("[[pw1]]", "");
+      p++;
 
-#if USING_BOARD_NAME
-            result.replace("[[nm]]",  "");
-#endif
-          }
+      return true;
+    }
 
-#if USE_DYNAMIC_PARAMETERS
+    //////////////////////////////////////////////
 
-          for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
-          {
-            String toChange = String("[[") + myMenuItems[i].id + "]]";
-            result.replace(toChange, myMenuItems[i].pdata);
-          }
+    // Parse the body in place. Fields not in the body are left as nullptr in values[], in the order of
+    // WiFi_Creds (ssid, pw) x NUM_WIFI_CREDENTIALS, board_name, then myMenuItems
+    bool parseConfigJSON(char* p, char** values)
+    {
+      if (!parseJSONChar(p, '{'))
+        return false;
 
-#endif
+      if (parseJSONChar(p, '}'))
+        return (*skipJSONSpaces(p) == 0);
 
-          ESP_WML_LOGDEBUG1(F("h:HTML page size:"), result.length());
-          ESP_WML_LOGDEBUG1(F("h:HTML="), result);
+      do
+      {
+        char* key = parseJSONString(p);
 
+        if ( !key || !parseJSONChar(p, ':') )
+          return false;
 
-#if ( ARDUINO_ESP32S2_DEV || ARDUINO_FEATHERS2 || ARDUINO_PROS2 || ARDUINO_MICROS2 )
+        if (!strcmp(key, "WiFi_Creds"))
+        {
+          if (!parseJSONChar(p, '['))
+            return false;
 
-          request->send(200, FPSTR(WM_HTTP_HEAD_TEXT_HTML), result);
+          if (!parseJSONChar(p, ']'))
+          {
+            uint8_t i = 0;
 
-          // Fix ESP32-S2 issue with WebServer (https://github.com/espressif/arduino-esp32/issues/4348)
-          delay(1);
-#else
+            do
+            {
+              if ( (i >= NUM_WIFI_CREDENTIALS) || !parseJSONChar(p, '{') )
+                return false;
 
-          AsyncWebServerResponse *response = request->beginResponse(200, FPSTR(WM_HTTP_HEAD_TEXT_HTML), result);
-          response->addHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+              if (!parseJSONChar(p, '}'))
+              {
+                do
+                {
+                  char* name = parseJSONString(p);
 
-#if USING_CORS_FEATURE
-          // New from v1.2.0, for configure CORS Header, default to WM_HTTP_CORS_ALLOW_ALL = "*"
-          ESP_WML_LOGDEBUG3(F("handleRequest:WM_HTTP_CORS:"), WM_HTTP_CORS, " : ", _CORS_Header);
-          response->addHeader(FPSTR(WM_HTTP_CORS), _CORS_Header);
-#endif
+                  if ( !name || !parseJSONChar(p, ':') )
+                    return false;
 
-          response->addHeader(FPSTR(WM_HTTP_PRAGMA), FPSTR(WM_HTTP_NO_CACHE));
-          response->addHeader(FPSTR(WM_HTTP_EXPIRES), "-1");
+                  char** value;
 
-          request->send(response);
+                  if (!strcmp(name, "wifi_ssid"))
+                    value = &values[2 * i];
+                  else if (!strcmp(name, "wifi_pw"))
+                    value = &values[2 * i + 1];
+                  else
+                    return false;
 
-#endif    // ARDUINO_ESP32S2_DEV
+                  if ( !(*value = parseJSONString(p)) )
+                    return false;
+                } while (parseJSONNext(p));
 
-          return;
-        }
+                if (!parseJSONChar(p, '}'))
+                  return false;
+              }
+
+              i++;
+            } while (parseJSONNext(p));
 
-        if (number_items_Updated == 0)
+            if (!parseJSONChar(p, ']'))
+              return false;
+          }
+        }
+        else if (!strcmp(key, "board_name"))
         {
-          memset(&ESP_WM_LITE_config, 0, sizeof(ESP_WM_LITE_config));
-          strcpy(ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE);
+          if ( !(values[NUM_CONFIG_API_FIELDS - 1] = parseJSONString(p)) )
+            return false;
         }
 
 #if USE_DYNAMIC_PARAMETERS
-
-        if (!menuItemUpdated)
+        else if (!strcmp(key, "menu"))
         {
-          // Don't need to free
-          menuItemUpdated = new bool[NUM_MENU_ITEMS];
+          if (!parseJSONChar(p, '{'))
+            return false;
 
-          if (menuItemUpdated)
+          if (!parseJSONChar(p, '}'))
           {
-            for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+            do
             {
-              // To flag item is not yet updated
-              menuItemUpdated[i] = false;
-            }
+              char* id = parseJSONString(p);
 
-            ESP_WML_LOGDEBUG(F("h: Init menuItemUpdated" ));
-          }
-          else
-          {
-            ESP_WML_LOGERROR(F("h: Error can't alloc memory for menuItemUpdated" ));
+              if ( !id || !parseJSONChar(p, ':') )
+                return false;
+
+              uint16_t i = 0;
+
+              while ( (i < NUM_MENU_ITEMS) && strcmp(id, myMenuItems[i].id) )
+                i++;
+
+              if ( (i == NUM_MENU_ITEMS) || !(values[NUM_CONFIG_API_FIELDS + i] = parseJSONString(p)) )
+                return false;
+            } while (parseJSONNext(p));
+
+            if (!parseJSONChar(p, '}'))
+              return false;
           }
         }
-
 #endif
+        else
+        {
+          ESP_WML_LOGERROR1(F("api:Unknown key"), key);
+          return false;
+        }
+      } while (parseJSONNext(p));
 
-        static bool id_Updated  = false;
-        static bool pw_Updated  = false;
-        static bool id1_Updated = false;
-        static bool pw1_Updated = false;
+      return ( parseJSONChar(p, '}') && (*skipJSONSpaces(p) == 0) );
+    }
 
-#if USING_BOARD_NAME
-        static bool nm_Updated  = false;
-#endif
+    //////////////////////////////////////////////
 
-        if (!id_Updated && (key == String("id")))
-        {
-          ESP_WML_LOGDEBUG(F("h:repl id"));
-          id_Updated = true;
+    // PUT ESP_WM_LITE_CONFIG_API_URL. Fields not in the body keep their current value. All fields are checked
+    // before any is applied, then everything is saved once
+    void handleConfigAPIPut(AsyncWebServerRequest *request)
+    {
+      if (!request)
+        return;
 
-          number_items_Updated++;
+      if (request->contentLength() > CONFIG_API_MAX_BODY_SIZE)
+      {
+        request->send(413, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "Too large");
+        return;
+      }
 
-          if (strlen(value.c_str()) < sizeof(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid) - 1)
-            strcpy(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, value.c_str());
-          else
-            strncpy(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, value.c_str(),
-                    sizeof(ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid) - 1);
-        }
-        else if (!pw_Updated && (key == String("pw")))
-        {
-          ESP_WML_LOGDEBUG(F("h:repl pw"));
-          pw_Updated = true;
+      if (!request->_tempObject)
+      {
+        request->send(400, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "No body");
+        return;
+      }
 
-          number_items_Updated++;
+#if USE_DYNAMIC_PARAMETERS
+      const uint16_t numValues = NUM_CONFIG_API_FIELDS + NUM_MENU_ITEMS;
+#else
+      const uint16_t numValues = NUM_CONFIG_API_FIELDS;
+#endif
 
-          if (strlen(value.c_str()) < sizeof(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw) - 1)
-            strcpy(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw, value.c_str());
-          else
-            strncpy(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw, value.c_str(), sizeof(ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw) - 1);
-        }
-        else if (!id1_Updated && (key == String("id1")))
-        {
-          ESP_WML_LOGDEBUG(F("h:repl id1"));
-          id1_Updated = true;
+      char** values = new char* [numValues];
 
-          number_items_Updated++;
+      if (!values)
+      {
+        request->send(500, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "No memory");
+        return;
+      }
 
-          if (strlen(value.c_str()) < sizeof(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid) - 1)
-            strcpy(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid, value.c_str());
-          else
-            strncpy(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid, value.c_str(),
-                    sizeof(ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid) - 1);
-        }
-        else if (!pw1_Updated && (key == String("pw1")))
-        {
-          ESP_WML_LOGDEBUG(F("h:repl pw1"));
-          pw1_Updated = true;
+      memset(values, 0, numValues * sizeof(char*));
 
-          number_items_Updated++;
+      if (!parseConfigJSON((char*) request->_tempObject, values))
+      {
+        delete [] values;
+        request->send(400, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "Invalid JSON");
+        return;
+      }
 
-          if (strlen(value.c_str()) < sizeof(ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw) - 1)
-            strcpy(ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw, value.c_str());
-          else
-            strncpy(ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw, value.c_str(), sizeof(ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw) - 1);
-        }
+      ESP_WM_LITE_Configuration& config = portalConfig();
 
-#if USING_BOARD_NAME
-        else if (!nm_Updated && (key == String("nm")))
-        {
-          ESP_WML_LOGDEBUG(F("h:repl nm"));
-          nm_Updated = true;
+      // Destinations of the Config Data values, in the same order as values[]
+      char* fields[NUM_CONFIG_API_FIELDS];
+      size_t sizes[NUM_CONFIG_API_FIELDS];
 
-          number_items_Updated++;
+      for (uint8_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
+      {
+        fields[2 * i]     = config.WiFi_Creds[i].wifi_ssid;
+        sizes[2 * i]      = sizeof(config.WiFi_Creds[i].wifi_ssid);
+        fields[2 * i + 1] = config.WiFi_Creds[i].wifi_pw;
+        sizes[2 * i + 1]  = sizeof(config.WiFi_Creds[i].wifi_pw);
+      }
 
-          if (strlen(value.c_str()) < sizeof(ESP_WM_LITE_config.board_name) - 1)
-            strcpy(ESP_WM_LITE_config.board_name, value.c_str());
-          else
-            strncpy(ESP_WM_LITE_config.board_name, value.c_str(), sizeof(ESP_WM_LITE_config.board_name) - 1);
-        }
+      fields[NUM_CONFIG_API_FIELDS - 1] = config.board_name;
+      sizes[NUM_CONFIG_API_FIELDS - 1]  = sizeof(config.board_name);
 
-#endif
+      // Reject, rather than truncate, values too long for their field
+      bool tooLong = false;
+
+      for (uint16_t i = 0; i < NUM_CONFIG_API_FIELDS; i++)
+      {
+        if ( values[i] && (strlen(values[i]) >= sizes[i]) )
+          tooLong = true;
+      }
 
 #if USE_DYNAMIC_PARAMETERS
-        else
-        {
-          for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
-          {
-            if ( !menuItemUpdated[i] && (key == myMenuItems[i].id) )
-            {
-              ESP_WML_LOGDEBUG3(F("h:"), myMenuItems[i].id, F("="), value.c_str() );
 
-              menuItemUpdated[i] = true;
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      {
+        const char* value = values[NUM_CONFIG_API_FIELDS + i];
 
-              number_items_Updated++;
+        if ( value && ((int) strlen(value) > myMenuItems[i].maxlen) )
+          tooLong = true;
+      }
 
-              // Actual size of pdata is [maxlen + 1]
-              memset(myMenuItems[i].pdata, 0, myMenuItems[i].maxlen + 1);
+#endif
 
-              if ((int) strlen(value.c_str()) < myMenuItems[i].maxlen)
-                strcpy(myMenuItems[i].pdata, value.c_str());
-              else
-                strncpy(myMenuItems[i].pdata, value.c_str(), myMenuItems[i].maxlen);
+      if (tooLong)
+      {
+        delete [] values;
+        request->send(400, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "Value too long");
+        return;
+      }
 
-              break;
-            }
-          }
-        }
+      ESP_WM_LITE_LOCK_PORTAL();
+
+#if USING_HOT_APPLY
+
+      if (!stageConfig())
+      {
+        delete [] values;
+        request->send(503, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), "Busy");
+        return;
+      }
 
 #endif
 
-        ESP_WML_LOGDEBUG1(F("h:items updated ="), number_items_Updated);
-        ESP_WML_LOGDEBUG3(F("h:key ="), key, ", value =", value);
+      // Invalid Config Data is not kept as base
+      if (!hadConfigData)
+        memset(&config, 0, sizeof(config));
 
-        request->send(200, FPSTR(WM_HTTP_HEAD_TEXT_HTML), "OK");
+      strcpy(config.header, ESP_WM_LITE_BOARD_TYPE);
+
+      for (uint16_t i = 0; i < NUM_CONFIG_API_FIELDS; i++)
+      {
+        if (values[i])
+          copyConfigValue(fields[i], sizes[i], values[i]);
+      }
 
 #if USE_DYNAMIC_PARAMETERS
 
-        if (number_items_Updated == NUM_CONFIGURABLE_ITEMS + NUM_MENU_ITEMS)
-#else
-        if (number_items_Updated == NUM_CONFIGURABLE_ITEMS)
-#endif
-        {
-#if USE_LITTLEFS
-          ESP_WML_LOGERROR1(F("h:Updating LittleFS:"), CONFIG_FILENAME);
-#elif USE_SPIFFS
-          ESP_WML_LOGERROR1(F("h:Updating SPIFFS:"), CONFIG_FILENAME);
-#else
-          ESP_WML_LOGERROR(F("h:Updating EEPROM. Please wait for reset"));
-#endif
+      for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+      {
+        if (values[NUM_CONFIG_API_FIELDS + i])
+          copyConfigValue(portalMenuData(i), myMenuItems[i].maxlen + 1, values[NUM_CONFIG_API_FIELDS + i]);
+      }
 
-          saveAllConfigData();
+#endif
 
-          // Done with CP, Clear CP Flag here if forced
-          if (isForcedConfigPortal)
-            clearForcedCP();
+      delete [] values;
 
-          ESP_WML_LOGERROR(F("h:Rst"));
+      request->send(200, FPSTR(WM_HTTP_HEAD_JSON), "{\"status\":\"OK\"}");
 
-          // TO DO : what command to reset
-          // Delay then reset the board after save data
-          resetFunc();
-        }
-      }   // if (server)
+      saveConfigAndApply();
     }
 
+#endif    // USING_CONFIG_API
+
     //////////////////////////////////////////////
 
 #ifndef CONFIG_TIMEOUT
@@ -3028,14 +7729,99 @@ class ESPAsync_WiFiManager_Lite
   #define CONFIG_TIMEOUT      60000L
 #endif
 
+    void addWiFiMultiAPs()
+    {
+      for (uint16_t i = 0; i < NUM_WIFI_CREDENTIALS; i++)
+      {
+        if ( strlen(ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw) >= PASSWORD_MIN_LEN )
+        {
+          ESP_WML_LOGDEBUG5(F("bg: addAP : index="), i, F(", SSID="), ESP_WM_LITE_config.WiFi_Creds[i].wifi_ssid, F(", PWD="),
+                            ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw);
+          wifiMulti.addAP(ESP_WM_LITE_config.WiFi_Creds[i].wifi_ssid, ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw);
+        }
+        else
+        {
+          ESP_WML_LOGWARN3(F("bg: Ignore invalid WiFi PWD : index="), i, F(", PWD="), ESP_WM_LITE_config.WiFi_Creds[i].wifi_pw);
+        }
+      }
+    }
+
+    //////////////////////////////////////////////
+
+    void stopConfigurationMode()
+    {
+      configuration_mode = false;
+
+#if USE_LED_BUILTIN
+      // turn the LED_BUILTIN OFF to tell us we exit configuration mode.
+      digitalWrite(LED_BUILTIN, LED_OFF);
+#endif
+
+      if (dnsServer)
+      {
+        dnsServer->stop();
+        delete dnsServer;
+        dnsServer = nullptr;
+      }
+
+      if (server)
+      {
+        server->end();
+        delete server;
+        server = nullptr;
+      }
+
+#if USING_HOT_APPLY
+      WiFi.softAPdisconnect(true);
+      WiFi.mode(WIFI_STA);
+#endif
+
+      // Portal page not needed anymore. Free the parsed template
+      clearHTMLSlots();
+    }
+
+    //////////////////////////////////////////////
+
     void startConfigurationMode()
     {
+      resetItemsUpdated();
+
+#if USING_NONBLOCKING_CONNECT
+      // Connection attempts resume from run() if the Config Portal times out
+      _connectState = WM_CONNECT_IDLE;
+#endif
+
 #if SCAN_WIFI_NETWORKS
       configTimeout = 0;  // To allow user input in CP
 
+#if USING_SCAN_CACHE
+      // Rescan, once the AP is up, only if the cached results are too old
+      _scanRunning      = !isScanCacheValid();
+#elif USING_ASYNC_WIFI_SCAN
+      // Started once the AP is up
+      WiFiNetworksFound = 0;
+      _scanRunning      = true;
+#else
       WiFiNetworksFound = scanWifiNetworks(&indices);
 #endif
 
+      {
+        ESP_WM_LITE_LOCK_PORTAL();
+
+#if USING_ASYNC_WIFI_SCAN
+        // Filled in by the page, or by pollWiFiScan() once the background scan is done
+        ListOfSSIDs = String(FPSTR(ESP_WM_LITE_OPTION_START)) + String(FPSTR(ESP_WM_LITE_SCANNING)) + String(FPSTR(ESP_WM_LITE_OPTION_END));
+#else
+        buildListOfSSIDs(ListOfSSIDs);
+#endif
+
+        // SSID list may have changed. Re-parse the page template on next request
+        clearHTMLSlots();
+      }
+#else
+      clearHTMLSlots();
+#endif
+
 #if USE_LED_BUILTIN
       // turn the LED_BUILTIN ON to tell us we are in configuration mode.
       digitalWrite(LED_BUILTIN, LED_ON);
@@ -3051,7 +7837,12 @@ class ESPAsync_WiFiManager_Lite
         portal_pass = "MyESP_" + chipID;
       }
 
+#if (USING_ASYNC_WIFI_SCAN || USING_AP_STA_PORTAL)
+      // STA needed to scan, or kept connected. Set now, so that the scan won't switch mode under the running AP
+      WiFi.mode(WIFI_AP_STA);
+#else
       WiFi.mode(WIFI_AP);
+#endif
 
       // New
       delay(100);
@@ -3067,6 +7858,14 @@ class ESPAsync_WiFiManager_Lite
       else
         channel = WiFiAPChannel;
 
+#if USING_AP_STA_PORTAL
+
+      // One radio : the AP can only be on the channel of the connected STA
+      if (WiFi.status() == WL_CONNECTED)
+        channel = WiFi.channel();
+
+#endif
+
       // softAPConfig() must be put before softAP() for ESP8266 core v3.0.0+ to work.
       // ESP32 or ESP8266is core v3.0.0- is OK either way
       WiFi.softAPConfig(portal_apIP, portal_apIP, IPAddress(255, 255, 255, 0));
@@ -3094,7 +7893,70 @@ class ESPAsync_WiFiManager_Lite
         // CaptivePortal
         // if DNSServer is started with "*" for domain name, it will reply with provided IP to all DNS requests
         dnsServer->start(DNS_PORT, "*", portal_apIP);
-        
+
+#if USING_CAPTIVE_PROBE_ROUTES
+        _portalURL = String("http://") + portal_apIP.toString() + "/";
+
+        for (uint8_t i = 0; i < NUM_PROBE_ROUTES; i++)
+        {
+          server->on(String(FPSTR(ESP_WM_LITE_PROBE_ROUTES[i].path)).c_str(), HTTP_GET, [this, i](AsyncWebServerRequest * request)
+          {
+            handleProbe(request, i);
+          });
+        }
+#endif
+
+#if USING_CONFIG_API
+        server->on(ESP_WM_LITE_CONFIG_API_URL, HTTP_GET, [this](AsyncWebServerRequest * request)
+        {
+          handleConfigAPIGet(request);
+        });
+
+        server->on(ESP_WM_LITE_CONFIG_API_URL, HTTP_PUT, [this](AsyncWebServerRequest * request)
+        {
+          handleConfigAPIPut(request);
+        }, nullptr, [this](AsyncWebServerRequest * request, uint8_t *data, size_t len, size_t index, size_t total)
+        {
+          handleConfigAPIBody(request, data, len, index, total);
+        });
+#endif
+
+#if USING_SCAN_CACHE
+        server->on(ESP_WM_LITE_SCAN_API_URL, HTTP_GET, [this](AsyncWebServerRequest * request)
+        {
+          handleScanAPIGet(request);
+        });
+
+        server->on(ESP_WM_LITE_SCAN_API_URL, HTTP_POST, [this](AsyncWebServerRequest * request)
+        {
+          handleScanAPIPost(request);
+        });
+#elif USING_ASYNC_WIFI_SCAN
+        server->on(ESP_WM_LITE_SCAN_URL, HTTP_GET, [this](AsyncWebServerRequest * request)
+        {
+          handleScanPoll(request);
+        });
+#endif
+
+        server->on(ESP_WM_LITE_SAVE_URL, HTTP_POST, [this](AsyncWebServerRequest * request)
+        {
+          handleSave(request);
+        });
+
+#if USING_GZIPPED_ASSETS
+        server->on(ESP_WM_LITE_CSS_URL, HTTP_GET, [this](AsyncWebServerRequest * request)
+        {
+          handleAsset(request, WM_HTTP_HEAD_TEXT_CSS, ESP_WM_LITE_CSS, ESP_WM_LITE_CSS_GZ, ESP_WM_LITE_CSS_GZ_LEN, ESP_WM_LITE_CSS_ETAG,
+                      ESP_WM_LITE_CSS_ETAG_GZ);
+        });
+
+        server->on(ESP_WM_LITE_JS_URL, HTTP_GET, [this](AsyncWebServerRequest * request)
+        {
+          handleAsset(request, WM_HTTP_HEAD_TEXT_JS, ESP_WM_LITE_JS, ESP_WM_LITE_JS_GZ, ESP_WM_LITE_JS_GZ_LEN, ESP_WM_LITE_JS_ETAG,
+                      ESP_WM_LITE_JS_ETAG_GZ);
+        });
+#endif
+
         // reply to all requests with same HTML
         server->onNotFound([this](AsyncWebServerRequest * request)
         {
@@ -3119,6 +7981,13 @@ class ESPAsync_WiFiManager_Lite
       }
 
       configuration_mode = true;
+
+#if USING_ASYNC_WIFI_SCAN
+
+      if (_scanRunning)
+        startWiFiScan();
+
+#endif
     }
 
 #if SCAN_WIFI_NETWORKS
@@ -3131,17 +8000,6 @@ class ESPAsync_WiFiManager_Lite
 
     //////////////////////////////////////////
 
-    void swap(int *thisOne, int *thatOne)
-    {
-      int tempo;
-
-      tempo    = *thatOne;
-      *thatOne = *thisOne;
-      *thisOne = tempo;
-    }
-
-    //////////////////////////////////////////
-
     void setMinimumSignalQuality(const int& quality)
     {
       _minimumQuality = quality;
@@ -3167,6 +8025,258 @@ class ESPAsync_WiFiManager_Lite
 
       ESP_WML_LOGDEBUG1(F("scanWifiNetworks: Done, Scanned Networks n = "), n);
 
+      return processWiFiScan(n, indicesptr);
+    }
+
+    //////////////////////////////////////////
+
+#if USING_ASYNC_WIFI_SCAN
+
+    // Async scan : returns WIFI_SCAN_RUNNING at once. Results are processed by pollWiFiScan()
+    bool startWiFiScan()
+    {
+      ESP_WML_LOGDEBUG(F("Scanning Network in background"));
+
+      _scanRunning = true;
+
+      if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED)
+      {
+        ESP_WML_LOGERROR(F("Scan failed to start"));
+
+#if !USING_SCAN_CACHE
+        // No "Scanning..." anymore : whatever the last scan found
+        String list;
+
+        buildListOfSSIDs(list);
+
+        ESP_WM_LITE_LOCK_PORTAL();
+
+        ListOfSSIDs = list;
+        clearHTMLSlots();
+#endif
+
+        _scanRunning = false;
+
+        return false;
+      }
+
+      return true;
+    }
+
+    //////////////////////////////////////////
+
+    // Called from run() in Config Portal mode. When the background scan is done, sort and filter its
+    // results, then have the page rebuilt with the SSID list
+    void pollWiFiScan()
+    {
+      if (!_scanRunning)
+        return;
+
+      int n = WiFi.scanComplete();
+
+      if (n == WIFI_SCAN_RUNNING)
+        return;
+
+      ESP_WML_LOGDEBUG1(F("pollWiFiScan: Done, Scanned Networks n = "), n);
+
+      WiFiNetworksFound = processWiFiScan(n, &indices);
+
+#if USING_SCAN_CACHE
+
+      // After the new results are swapped in by fillScanCache()
+      ESP_WM_LITE_LOCK_PORTAL();
+
+      _scanRunning = false;
+
+#else
+
+      // Build the list first, then publish it with the page rebuilt from it. The scan is only seen as done,
+      // by handleScanPoll() and the page, once the list is there
+      String list;
+
+      buildListOfSSIDs(list);
+
+      ESP_WM_LITE_LOCK_PORTAL();
+
+      ListOfSSIDs = list;
+      clearHTMLSlots();
+
+      _scanRunning = false;
+
+#endif
+    }
+
+    //////////////////////////////////////////
+
+    // GET ESP_WM_LITE_SCAN_URL : 202 while scanning, then the SSID <option> list
+    void handleScanPoll(AsyncWebServerRequest *request)
+    {
+      if (!request)
+        return;
+
+      ESP_WM_LITE_LOCK_PORTAL();
+
+      if (_scanRunning)
+        request->send(202);
+      else
+        request->send(200, FPSTR(WM_HTTP_HEAD_TEXT_HTML), ListOfSSIDs);
+    }
+
+#endif
+
+#if USING_SCAN_CACHE
+
+    bool isScanCacheValid()
+    {
+      return _scanCacheFilled && (millis() - _scanCacheTime < SCAN_CACHE_TTL);
+    }
+
+    //////////////////////////////////////////
+
+    // Keep the n sorted scan results, while the WiFi driver still has them. indices[i] is -1 for entries[i]
+    // not to be listed. Filled into a new buffer, swapped in under the portal lock, as handleScanAPIGet()
+    // may be printing the old one
+    void fillScanCache(const ESP_WM_LITE_Scan_Entry* entries, const int* indices, const int& n)
+    {
+      const uint8_t numResults = (n > SCAN_CACHE_MAX_SIZE) ? SCAN_CACHE_MAX_SIZE : n;
+
+      ESP_WM_LITE_Scan_Result* scanCache = nullptr;
+
+      if (numResults > 0)
+      {
+        scanCache = (ESP_WM_LITE_Scan_Result *) malloc(numResults * sizeof(ESP_WM_LITE_Scan_Result));
+
+        if (scanCache == NULL)
+        {
+          ESP_WML_LOGDEBUG(F("ERROR: Out of memory, scan not cached"));
+
+          ESP_WM_LITE_LOCK_PORTAL();
+
+          _scanCacheFilled = false;
+
+          return;
+        }
+      }
+
+      for (uint8_t i = 0; i < numResults; i++)
+      {
+        ESP_WM_LITE_Scan_Result& result = scanCache[i];
+
+        strncpy(result.ssid, WiFi.SSID(entries[i].index).c_str(), sizeof(result.ssid) - 1);
+        result.ssid[sizeof(result.ssid) - 1] = 0;
+        result.rssi       = entries[i].rssi;
+        result.channel    = entries[i].channel;
+        result.encryption = WiFi.encryptionType(entries[i].index);
+        result.listed     = (indices[i] != -1);
+        memcpy(result.bssid, entries[i].bssid, sizeof(result.bssid));
+      }
+
+      ESP_WM_LITE_Scan_Result* oldScanCache;
+
+      {
+        ESP_WM_LITE_LOCK_PORTAL();
+
+        oldScanCache      = _scanCache;
+
+        _scanCache        = scanCache;
+        _numScanCache     = numResults;
+        _scanCacheFilled  = true;
+        _scanCacheTime    = millis();
+      }
+
+      free(oldScanCache);
+
+      ESP_WML_LOGDEBUG1(numResults, F(" scan results cached"));
+    }
+
+    //////////////////////////////////////////
+
+    // GET ESP_WM_LITE_SCAN_API_URL. The listed networks, printed straight from the cache
+    // {"scanning":false,"age":<ms>,"networks":[{"ssid":"","rssi":-50,"ch":1,"bssid":"aa:bb:cc:dd:ee:ff","auth":3},...]}
+    void handleScanAPIGet(AsyncWebServerRequest *request)
+    {
+      if (!request)
+        return;
+
+      // The cache can't be swapped by fillScanCache() while printed
+      ESP_WM_LITE_LOCK_PORTAL();
+
+      AsyncResponseStream *response = request->beginResponseStream(FPSTR(WM_HTTP_HEAD_JSON));
+
+      response->addHeader(FPSTR(WM_HTTP_CACHE_CONTROL), FPSTR(WM_HTTP_NO_STORE));
+
+      response->print(F("{\"scanning\":"));
+      response->print(_scanRunning ? F("true") : F("false"));
+      response->print(F(",\"age\":"));
+      response->print(_scanCacheFilled ? (millis() - _scanCacheTime) : 0);
+      response->print(F(",\"networks\":["));
+
+      // Only once the scan is done : the page keeps polling meanwhile
+      for (uint8_t i = 0, list_items = 0; !_scanRunning && (i < _numScanCache) && (list_items < MAX_SSID_IN_LIST); i++)
+      {
+        const ESP_WM_LITE_Scan_Result& result = _scanCache[i];
+
+        if (!result.listed)
+          continue;
+
+        char bssid[18];
+
+        snprintf(bssid, sizeof(bssid), "%02x:%02x:%02x:%02x:%02x:%02x", result.bssid[0], result.bssid[1],
+                 result.bssid[2], result.bssid[3], result.bssid[4], result.bssid[5]);
+
+        response->print(list_items ? F(",{\"ssid\":") : F("{\"ssid\":"));
+        printJSONString(*response, result.ssid);
+        response->print(F(",\"rssi\":"));
+        response->print(result.rssi);
+        response->print(F(",\"ch\":"));
+        response->print(result.channel);
+        response->print(F(",\"bssid\":\""));
+        response->print(bssid);
+        response->print(F("\",\"auth\":"));
+        response->print(result.encryption);
+        response->print('}');
+
+        list_items++;
+      }
+
+      response->print(F("]}"));
+
+      request->send(response);
+    }
+
+    //////////////////////////////////////////
+
+    // POST ESP_WM_LITE_SCAN_API_URL : rescan in the background, whatever the age of the cache
+    void handleScanAPIPost(AsyncWebServerRequest *request)
+    {
+      if (!request)
+        return;
+
+      ESP_WM_LITE_LOCK_PORTAL();
+
+      if (!_scanRunning && !startWiFiScan())
+      {
+        request->send(500, FPSTR(WM_HTTP_HEAD_TEXT_PLAIN), F("Scan failed to start"));
+        return;
+      }
+
+      request->send(202);
+    }
+
+#endif
+
+    //////////////////////////////////////////
+
+    // Sort by RSSI, remove duplicates and low quality networks from the n scan results
+    int processWiFiScan(const int& n, int **indicesptr)
+    {
+      if (*indicesptr)
+      {
+        // From previous scan
+        free(*indicesptr);
+        *indicesptr = NULL;
+      }
+
       //KH, Terrible bug here. WiFi.scanNetworks() returns n < 0 => malloc( negative == very big ) => crash!!!
       //In .../esp32/libraries/WiFi/src/WiFiType.h
       //#define WIFI_SCAN_RUNNING   (-1)
@@ -3175,97 +8285,145 @@ class ESPAsync_WiFiManager_Lite
       if (n <= 0)
       {
         ESP_WML_LOGDEBUG(F("No network found"));
+
+#if USING_SCAN_CACHE
+
+        // Nothing in range is a valid result too. A failed scan is not
+        if (n == 0)
+          fillScanCache(NULL, NULL, 0);
+
+#endif
+
         return (0);
       }
-      else
+
+      // Allocate space off the heap for indices array.
+      // This space should be freed when no longer required.
+      int* indices = (int *) malloc(n * sizeof(int));
+      ESP_WM_LITE_Scan_Entry* entries = (ESP_WM_LITE_Scan_Entry *) malloc(n * sizeof(ESP_WM_LITE_Scan_Entry));
+
+      if ( (indices == NULL) || (entries == NULL) )
       {
-        // Allocate space off the heap for indices array.
-        // This space should be freed when no longer required.
-        int* indices = (int *)malloc(n * sizeof(int));
+        ESP_WML_LOGDEBUG(F("ERROR: Out of memory"));
 
-        if (indices == NULL)
-        {
-          ESP_WML_LOGDEBUG(F("ERROR: Out of memory"));
-          *indicesptr = NULL;
-          return (0);
-        }
+        free(indices);
+        free(entries);
 
-        *indicesptr = indices;
+        return (0);
+      }
 
-        //sort networks
-        for (int i = 0; i < n; i++)
-        {
-          indices[i] = i;
-        }
+      *indicesptr = indices;
 
-        ESP_WML_LOGDEBUG(F("Sorting"));
+      // Read each result only once from the WiFi driver
+      for (int i = 0; i < n; i++)
+      {
+        const String ssid   = WiFi.SSID(i);
+        const uint8_t* bssid = WiFi.BSSID(i);
 
-        // RSSI SORT
-        // old sort
-        for (int i = 0; i < n; i++)
-        {
-          for (int j = i + 1; j < n; j++)
-          {
-            if (WiFi.RSSI(indices[j]) > WiFi.RSSI(indices[i]))
-            {
-              //std::swap(indices[i], indices[j]);
-              // Using locally defined swap()
-              swap(&indices[i], &indices[j]);
-            }
-          }
-        }
+        entries[i].ssidHash = hashBytes(ssid.c_str(), ssid.length());
+        entries[i].index    = i;
+        entries[i].rssi     = WiFi.RSSI(i);
+        entries[i].channel  = WiFi.channel(i);
+
+        if (bssid)
+          memcpy(entries[i].bssid, bssid, sizeof(entries[i].bssid));
+        else
+          memset(entries[i].bssid, 0, sizeof(entries[i].bssid));
+      }
+
+      ESP_WML_LOGDEBUG(F("Sorting"));
+
+      // RSSI SORT, strongest first. Equal RSSI keep the scan order
+      std::sort(entries, entries + n, [](const ESP_WM_LITE_Scan_Entry & a, const ESP_WM_LITE_Scan_Entry & b)
+      {
+        return (a.rssi != b.rssi) ? (a.rssi > b.rssi) : (a.index < b.index);
+      });
+
+      for (int i = 0; i < n; i++)
+      {
+        indices[i] = entries[i].index;
+      }
 
+      // remove duplicates ( must be RSSI sorted ), keeping the strongest of each SSID
+      if (_removeDuplicateAPs)
+      {
         ESP_WML_LOGDEBUG(F("Removing Dup"));
 
-        // remove duplicates ( must be RSSI sorted )
-        if (_removeDuplicateAPs)
+        // Open addressing hash set of the SSIDs already kept, as positions in entries[], -1 if free.
+        // At least twice as many slots as entries, to keep probing short
+        uint16_t numSlots = 4;
+
+        while (numSlots < 2 * n)
+          numSlots <<= 1;
+
+        int16_t* slots = (int16_t *) malloc(numSlots * sizeof(int16_t));
+
+        if (slots == NULL)
+        {
+          ESP_WML_LOGDEBUG(F("ERROR: Out of memory, dup not removed"));
+        }
+        else
         {
-          String cssid;
+          memset(slots, 0xFF, numSlots * sizeof(int16_t));
 
           for (int i = 0; i < n; i++)
           {
-            if (indices[i] == -1)
-              continue;
+            uint16_t slot = entries[i].ssidHash & (numSlots - 1);
 
-            cssid = WiFi.SSID(indices[i]);
-
-            for (int j = i + 1; j < n; j++)
+            while (slots[slot] != -1)
             {
-              if (cssid == WiFi.SSID(indices[j]))
+              const ESP_WM_LITE_Scan_Entry& kept = entries[slots[slot]];
+
+              // Same hash : compare the SSIDs themselves, to be sure
+              if ( (kept.ssidHash == entries[i].ssidHash) && (WiFi.SSID(kept.index) == WiFi.SSID(entries[i].index)) )
               {
-                ESP_WML_LOGDEBUG1("DUP AP:", WiFi.SSID(indices[j]));
-                indices[j] = -1; // set dup aps to index -1
+                ESP_WML_LOGDEBUG1("DUP AP:", WiFi.SSID(entries[i].index));
+                indices[i] = -1; // set dup aps to index -1
+                break;
               }
-            }
-          }
-        }
-
-        for (int i = 0; i < n; i++)
-        {
-          if (indices[i] == -1)
-            continue; // skip dups
 
-          int quality = getRSSIasQuality(WiFi.RSSI(indices[i]));
+              slot = (slot + 1) & (numSlots - 1);
+            }
 
-          if (!(_minimumQuality == -1 || _minimumQuality < quality))
-          {
-            indices[i] = -1;
-            ESP_WML_LOGDEBUG(F("Skipping low quality"));
+            if (indices[i] != -1)
+              slots[slot] = i;
           }
+
+          free(slots);
         }
+      }
+
+      for (int i = 0; i < n; i++)
+      {
+        if (indices[i] == -1)
+          continue; // skip dups
 
-        ESP_WML_LOGWARN(F("WiFi networks found:"));
+        int quality = getRSSIasQuality(entries[i].rssi);
 
-        for (int i = 0; i < n; i++)
+        if (!(_minimumQuality == -1 || _minimumQuality < quality))
         {
-          if (indices[i] == -1)
-            continue; // skip dups
-          else
-            ESP_WML_LOGWARN5(i + 1, ": ", WiFi.SSID(indices[i]), ", ", WiFi.RSSI(i), "dB");
+          indices[i] = -1;
+          ESP_WML_LOGDEBUG(F("Skipping low quality"));
         }
+      }
 
-        return (n);
+      ESP_WML_LOGWARN(F("WiFi networks found:"));
+
+      for (int i = 0; i < n; i++)
+      {
+        if (indices[i] == -1)
+          continue; // skip dups
+        else
+          ESP_WML_LOGWARN5(i + 1, ": ", WiFi.SSID(indices[i]), ", ", entries[i].rssi, "dB");
       }
+
+#if USING_SCAN_CACHE
+      fillScanCache(entries, indices, n);
+#endif
+
+      free(entries);
+
+      return (n);
     }
 
     //////////////////////////////////////////
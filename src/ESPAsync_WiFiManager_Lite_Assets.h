@@ -0,0 +1,77 @@
+/****************************************************************************************************************************
+  ESPAsync_WiFiManager_Lite_Assets.h
+  For ESP8266 / ESP32 boards
+
+  ESPAsync_WiFiManager_Lite (https://github.com/khoih-prog/ESPAsync_WiFiManager_Lite) is a library
+  for the ESP32/ESP8266 boards to enable store Credentials in EEPROM/SPIFFS/LittleFS for easy
+  configuration/reconfiguration and autoconnect/autoreconnect of WiFi and other services without Hardcoding.
+
+  Built by Khoi Hoang https://github.com/khoih-prog/ESPAsync_WiFiManager_Lite
+  Licensed under MIT license
+
+  GENERATED by utils/gzip_assets.py from utils/assets/. DO NOT EDIT
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef ESPAsync_WiFiManager_Lite_Assets_h
+#define ESPAsync_WiFiManager_Lite_Assets_h
+
+//////////////////////////////////////////
+// wm.css : 212 bytes, 181 bytes gzipped
+
+#define ESP_WM_LITE_CSS_VERSION      "886745c1"
+#define ESP_WM_LITE_CSS_GZ_LEN       181
+
+const char ESP_WM_LITE_CSS[] PROGMEM = "div,input{padding:5px;font-size:1em;}input{width:95%;}body{text-align: center;}button{background-color:#16A1E7;color:#fff;line-height:2.4rem;font-size:1.2rem;width:100%;}fieldset{border-radius:0.3rem;margin:0px;}";
+
+const uint8_t ESP_WM_LITE_CSS_GZ[] PROGMEM =
+{
+  0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x4D, 0x8E, 0xCD, 0x0E, 0x82, 0x30,
+  0x10, 0x84, 0x5F, 0xC5, 0xC4, 0x78, 0xB3, 0x04, 0xF0, 0x2F, 0xB6, 0x27, 0x0F, 0x3E, 0x48, 0x61,
+  0xB7, 0x65, 0x23, 0x6C, 0x49, 0x59, 0x14, 0x25, 0xBC, 0xBB, 0x10, 0x3C, 0x78, 0x9C, 0x99, 0x2F,
+  0xF9, 0x06, 0xE8, 0xB9, 0x27, 0x6E, 0x7B, 0x19, 0x5B, 0x0B, 0x40, 0xEC, 0xF5, 0xA9, 0x1D, 0x8C,
+  0x0B, 0x2C, 0xAA, 0xA3, 0x0F, 0xEA, 0x0C, 0x1B, 0x33, 0xAD, 0xC0, 0x8B, 0x40, 0x2A, 0x7D, 0x3D,
+  0xED, 0xCC, 0x54, 0x04, 0x78, 0x8F, 0x82, 0x83, 0x28, 0x5B, 0x93, 0x67, 0xBD, 0x29, 0x91, 0x05,
+  0xE3, 0x3C, 0xF4, 0x22, 0x81, 0xC7, 0xC2, 0x96, 0x0F, 0x1F, 0x43, 0xCF, 0xA0, 0xCA, 0x50, 0x87,
+  0xA8, 0xB7, 0xD9, 0xF9, 0x96, 0xDD, 0x2F, 0xE6, 0x97, 0x9C, 0x73, 0xA6, 0x26, 0x46, 0x55, 0x21,
+  0xF9, 0x4A, 0x74, 0x9E, 0x1C, 0xE3, 0x2C, 0xFA, 0xD3, 0x26, 0xF9, 0x52, 0xAC, 0xCA, 0x2C, 0x4D,
+  0x67, 0xA7, 0x23, 0xAC, 0xA1, 0x43, 0x19, 0x8B, 0x10, 0x01, 0xA3, 0x8A, 0x16, 0xA8, 0xEF, 0x74,
+  0x9A, 0x1C, 0x16, 0xB2, 0xB1, 0xD1, 0x13, 0xEB, 0x74, 0x3E, 0x3F, 0x7D, 0x01, 0xC1, 0x45, 0x67,
+  0x88, 0xD4, 0x00, 0x00, 0x00,
+};
+
+//////////////////////////////////////////
+// wm.js : 435 bytes, 321 bytes gzipped
+
+#define ESP_WM_LITE_JS_VERSION      "21527e31"
+#define ESP_WM_LITE_JS_GZ_LEN       321
+
+const char ESP_WM_LITE_JS[] PROGMEM = "function sv(){var e=document.querySelectorAll('input[id],select[id]'),b=[];\nfor(var i=0;i<e.length;i++){b.push(encodeURIComponent(e[i].id)+'='+encodeURIComponent(e[i].value));}\nvar r=new XMLHttpRequest();r.open('POST','/save',true);\nr.onload=function(){alert(r.status==200?'Updated':r.responseText);};r.onerror=function(){alert('Not sent');};\nr.setRequestHeader('Content-Type','application/x-www-form-urlencoded');r.send(b.join('&'));}";
+
+const uint8_t ESP_WM_LITE_JS_GZ[] PROGMEM =
+{
+  0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x75, 0x90, 0x4B, 0x6B, 0xC3, 0x30,
+  0x10, 0x84, 0xEF, 0xF9, 0x15, 0x3E, 0x55, 0x32, 0xB6, 0x95, 0xD0, 0x63, 0x5D, 0x51, 0x4A, 0x2E,
+  0x29, 0xF4, 0x45, 0x1E, 0x50, 0x08, 0x39, 0x28, 0xD6, 0xA6, 0x51, 0x51, 0x24, 0x55, 0x5A, 0xD9,
+  0x09, 0xA1, 0xFF, 0xBD, 0x52, 0x9B, 0x5B, 0xE9, 0x4D, 0x68, 0x77, 0xE7, 0x9B, 0x99, 0x5D, 0x34,
+  0x1D, 0x2A, 0x6B, 0x8A, 0xD0, 0xD3, 0xF2, 0xDC, 0x0B, 0x5F, 0x00, 0x97, 0xB6, 0x8B, 0x07, 0x30,
+  0xC8, 0x3E, 0x23, 0xF8, 0xD3, 0x02, 0x34, 0x74, 0x68, 0xFD, 0xBD, 0xD6, 0x94, 0x28, 0xE3, 0x22,
+  0xAE, 0x95, 0xDC, 0xD4, 0xE1, 0xE7, 0x3B, 0x3F, 0x49, 0x59, 0x6F, 0xF9, 0x7A, 0xD3, 0x8E, 0x76,
+  0xD6, 0xD3, 0xAC, 0xA0, 0xF8, 0xA4, 0x55, 0xB7, 0xC0, 0x34, 0x98, 0x77, 0xDC, 0xB7, 0xAA, 0xAA,
+  0xCA, 0xF3, 0x96, 0xB9, 0x18, 0xF6, 0x14, 0x4C, 0x67, 0x25, 0xAC, 0xE6, 0x0F, 0x53, 0x7B, 0x70,
+  0xD6, 0x24, 0x08, 0x85, 0xB5, 0xDA, 0x30, 0x25, 0xCB, 0x8A, 0x70, 0x52, 0xFD, 0x37, 0xEF, 0x85,
+  0x8E, 0x50, 0x96, 0xED, 0xD7, 0x28, 0x03, 0x3C, 0x37, 0x30, 0x14, 0x6F, 0x4F, 0x8F, 0x33, 0x44,
+  0x37, 0x87, 0x64, 0x33, 0x20, 0x2D, 0x5B, 0xCF, 0xAC, 0x03, 0x43, 0xC9, 0xEB, 0xCB, 0x62, 0x49,
+  0x6A, 0x32, 0x0E, 0xA2, 0x07, 0x52, 0xA3, 0x4F, 0x97, 0xED, 0x28, 0x0D, 0x8D, 0xB6, 0x42, 0xF2,
+  0xDD, 0x25, 0x71, 0x8A, 0x2B, 0x34, 0x78, 0xA4, 0x9E, 0x05, 0x14, 0x18, 0x03, 0xE7, 0xD7, 0x93,
+  0xC9, 0x1D, 0x59, 0x39, 0x29, 0x10, 0x24, 0xB9, 0xF1, 0xCC, 0x43, 0x48, 0x26, 0x02, 0x2C, 0xE1,
+  0x88, 0x89, 0x9D, 0x01, 0x06, 0xBC, 0xB7, 0xFE, 0xAF, 0x08, 0x79, 0xB6, 0x58, 0x84, 0xE4, 0x97,
+  0xE4, 0xC5, 0x44, 0x0B, 0x80, 0x17, 0x67, 0x33, 0x10, 0x12, 0x3C, 0x25, 0x53, 0x6B, 0x30, 0x2D,
+  0x34, 0xCB, 0x93, 0x4B, 0xB6, 0x88, 0x70, 0x4E, 0xAB, 0x4E, 0x64, 0x95, 0xF1, 0xB1, 0x19, 0x86,
+  0xA1, 0x49, 0xFD, 0x1D, 0x9A, 0xE8, 0xF5, 0x6F, 0x09, 0x92, 0xE4, 0x44, 0x49, 0x52, 0xD2, 0x2D,
+  0xFB, 0xB0, 0x2A, 0x05, 0xBB, 0x22, 0xB9, 0x82, 0x6F, 0x31, 0x7E, 0x52, 0x21, 0xB3, 0x01, 0x00,
+  0x00,
+};
+
+#endif    //ESPAsync_WiFiManager_Lite_Assets_h
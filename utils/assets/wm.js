@@ -0,0 +1,5 @@
+function sv(){var e=document.querySelectorAll('input[id],select[id]'),b=[];
+for(var i=0;i<e.length;i++){b.push(encodeURIComponent(e[i].id)+'='+encodeURIComponent(e[i].value));}
+var r=new XMLHttpRequest();r.open('POST','/save',true);
+r.onload=function(){alert(r.status==200?'Updated':r.responseText);};r.onerror=function(){alert('Not sent');};
+r.setRequestHeader('Content-Type','application/x-www-form-urlencoded');r.send(b.join('&'));}
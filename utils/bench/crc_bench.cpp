@@ -0,0 +1,87 @@
+// Checksum of a 2 KB record : slice-by-4 calcCRC32() of ESP8266, against the byte-sums it replaces.
+// ESP32 uses the ROM crc32_le(), which can't be timed on the host
+
+#define USE_DYNAMIC_PARAMETERS    true
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+#include <esp_rom_crc.h>
+
+#include <chrono>
+
+#define RECORD_LEN    2048
+#define RUNS          200000
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+static uint8_t record[RECORD_LEN];
+
+// Previous calcChecksum() of the Config Data, over a record of len bytes
+__attribute__((noinline)) static int oldConfigSum(const uint8_t* data, const uint16_t& len)
+{
+  int checkSum = 0;
+
+  for (uint16_t index = 0; index < len; index++)
+  {
+    checkSum += * ( ( (byte*) data ) + index);
+  }
+
+  return checkSum;
+}
+
+typedef std::function<uint32_t(void)> Checksum;
+
+static double usPerRun(const Checksum& checksum)
+{
+  volatile uint32_t sink = 0;
+
+  const auto t0 = std::chrono::steady_clock::now();
+
+  // One byte changes per run, so that nothing is hoisted out of the loop
+  for (int k = 0; k < RUNS; k++)
+  {
+    record[k % RECORD_LEN]++;
+    sink = sink + checksum();
+  }
+
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / RUNS;
+}
+
+int main()
+{
+  ESPAsync_WiFiManager_Lite wm;
+
+  int failures = 0;
+
+  for (int i = 0; i < RECORD_LEN; i++)
+    record[i] = rand();
+
+  // Check value of CRC-32, then all lengths and alignments against the bitwise reference
+  if (wm.calcCRC32(0, "123456789", 9) != 0xCBF43926)
+    failures++;
+
+  for (int offset = 0; offset < 4; offset++)
+  {
+    for (int len = 0; len < 64; len++)
+    {
+      if (wm.calcCRC32(0x12345678, record + offset, len) != esp_rom_crc32_le(0x12345678, record + offset, len))
+        failures++;
+    }
+  }
+
+  // Dynamic data : calcDynamicSum() is the previous loop over char, kept to accept data of previous versions
+  const double configSum  = usPerRun([&]() { return oldConfigSum(record, RECORD_LEN); });
+  const double dynamicSum = usPerRun([&]() { return wm.calcDynamicSum((const char*) record, RECORD_LEN); });
+  const double crc        = usPerRun([&]() { return wm.calcCRC32(0, record, RECORD_LEN); });
+
+  printf("2 KB : byte-sum (Config Data) %.2f us, byte-sum (dynamic data) %.2f us, CRC32 %.2f us = %.1fx dynamic byte-sum, "
+         "CRC32 correct=%d\n", configSum, dynamicSum, crc, crc / dynamicSum, failures == 0);
+
+  return failures ? 1 : 0;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
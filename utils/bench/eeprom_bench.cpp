@@ -0,0 +1,136 @@
+// EEPROM dynamic data : block access (ESP8266 in place in the RAM copy, ESP32 through readBytes()), against the previous
+// byte-wise EEPROM.read() / write()
+// The mock EEPROM has out-of-line, bounds-checked read() / write() like the cores. Both use the same checksum
+
+#define USE_LITTLEFS              false
+#define USE_SPIFFS                false
+#define USE_DYNAMIC_PARAMETERS    true
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+#include <chrono>
+
+#define MAX_ITEMS     18
+#define ITEM_LEN      100
+#define RUNS          20000
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+static char values[MAX_ITEMS][ITEM_LEN + 1];
+
+MenuItem myMenuItems [MAX_ITEMS];
+uint16_t NUM_MENU_ITEMS = 0;
+
+static ESPAsync_WiFiManager_Lite* wm;
+
+#define DYNAMIC_DATA_START    (CONFIG_EEPROM_START + sizeof(wm->ESP_WM_LITE_config) + FORCED_CONFIG_PORTAL_FLAG_DATA_SIZE)
+
+// Previous EEPROM_putDynamicData()
+static void oldPut()
+{
+  uint16_t offset = DYNAMIC_DATA_START;
+
+  for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+  {
+    const char* _pointer = myMenuItems[i].pdata;
+
+    for (uint16_t j = 0; j < myMenuItems[i].maxlen; j++, _pointer++, offset++)
+      EEPROM.write(offset, *_pointer);
+  }
+
+  EEPROM.put(offset, wm->calcMenuItemsChecksum());
+}
+
+// Previous EEPROM_getDynamicData() : read into a staging buffer, verify, then scatter
+static bool oldGet()
+{
+  const uint16_t len = wm->dynamicDataSize();
+
+  char* readBuffer = new char[len];
+
+  uint16_t offset = DYNAMIC_DATA_START;
+
+  for (uint16_t j = 0; j < len; j++, offset++)
+    readBuffer[j] = EEPROM.read(offset);
+
+  const bool valid = wm->isDynamicDataValid(readBuffer);
+
+  if (valid)
+    wm->scatterDynamicData(readBuffer);
+
+  delete [] readBuffer;
+
+  return valid;
+}
+
+static double usPerCall(const std::chrono::steady_clock::time_point& t0, const std::chrono::steady_clock::time_point& t1)
+{
+  return std::chrono::duration<double, std::micro>(t1 - t0).count() / RUNS;
+}
+
+int main()
+{
+  wm = new ESPAsync_WiFiManager_Lite();
+
+  EEPROM.begin(EEPROM_SIZE);
+
+  for (int i = 0; i < MAX_ITEMS; i++)
+  {
+    memset(values[i], 'a' + i, ITEM_LEN);
+    values[i][ITEM_LEN] = 0;
+
+    myMenuItems[i] = { "p", "P", values[i], ITEM_LEN };
+  }
+
+  int failures = 0;
+
+  for (int n : { 1, 10, MAX_ITEMS })
+  {
+    NUM_MENU_ITEMS = n;
+
+    bool oldValid = true;
+    bool newValid = true;
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    for (int k = 0; k < RUNS; k++)
+    {
+      values[0][k % ITEM_LEN] ^= 1;
+      oldPut();
+    }
+
+    const auto t1 = std::chrono::steady_clock::now();
+
+    for (int k = 0; k < RUNS; k++)
+      oldValid &= oldGet();
+
+    const auto t2 = std::chrono::steady_clock::now();
+
+    for (int k = 0; k < RUNS; k++)
+    {
+      values[0][k % ITEM_LEN] ^= 1;
+      wm->EEPROM_putDynamicData();
+    }
+
+    const auto t3 = std::chrono::steady_clock::now();
+
+    for (int k = 0; k < RUNS; k++)
+      newValid &= wm->EEPROM_getDynamicData();
+
+    const auto t4 = std::chrono::steady_clock::now();
+
+    if (!oldValid || !newValid)
+      failures++;
+
+    printf("%4d B : byte-wise save %5.2f us, load %5.2f us ; block save %5.2f us, load %5.2f us ; valid=%d\n",
+           n * ITEM_LEN, usPerCall(t0, t1), usPerCall(t1, t2), usPerCall(t2, t3), usPerCall(t3, t4), oldValid && newValid);
+  }
+
+  return failures ? 1 : 0;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
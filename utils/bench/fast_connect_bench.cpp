@@ -0,0 +1,88 @@
+// USING_FAST_CONNECT : boot-to-IP with and without the RTC record of the last AP.
+// The times are simulated from a model of the WiFi driver, not measured :
+// a WiFiMulti or WiFi.begin(ssid) connection takes FULL_CONNECT_MS, a directed WiFi.begin(.., channel, bssid) DIRECT_CONNECT_MS
+
+#define USING_FAST_CONNECT        true
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+// All-channel scan ~2.2 s, then association and DHCP ~0.3 s
+#define FULL_CONNECT_MS         2500
+#define DIRECT_CONNECT_MS       300
+
+extern unsigned long mockMillis;
+extern unsigned long multiRunBlockMs;
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+static ESPAsync_WiFiManager_Lite* wm;
+
+static void boot(const char* what)
+{
+  WiFi.staStatus  = WL_DISCONNECTED;
+  WiFi.connectAt  = 0;
+  WiFi.lastBssid  = NULL;
+
+  const unsigned long t0 = mockMillis;
+
+#if USING_NONBLOCKING_CONNECT
+  wm->_connectState = WM_CONNECT_IDLE;
+  wm->connectWiFiStep();
+
+  while (wm->_connectState != WM_CONNECT_CONNECTED)
+  {
+    mockMillis += 10;
+    wm->connectWiFiStep();
+  }
+
+#else
+  wm->connectMultiWiFi();
+#endif
+
+  printf("  %-28s boot-to-IP %5lu ms simulated, last WiFi.begin() directed=%d\n", what, mockMillis - t0, WiFi.lastBssid != NULL);
+}
+
+int main()
+{
+  wm  = new ESPAsync_WiFiManager_Lite();
+  drd = new DoubleResetDetector(10, 0);
+
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, "office");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw,   "12345678");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid, "home");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw,   "abcdefgh");
+  wm->hadConfigData = true;
+
+  // Power-on garbage in RTC memory, already in the rtcUserMemory of the ESP8266 mock
+#ifdef ESP32
+  memset(&ESP_WM_LITE_fastConnectRTC, 0xA5, sizeof(ESP_WM_LITE_fastConnectRTC));
+#endif
+
+  multiRunBlockMs   = FULL_CONNECT_MS;
+  WiFi.scanBeginMs  = FULL_CONNECT_MS;
+  WiFi.directMs     = DIRECT_CONNECT_MS;
+  WiFi.bssid[0]     = 0xAA;
+  WiFi.bssid[5]     = 0x55;
+
+  boot("cold (no RTC record)");
+  boot("after reset (RTC record)");
+
+  // The AP moved : the directed connection times out
+  WiFi.directMs = 100000;
+  boot("record stale (AP gone)");
+
+  WiFi.directMs = DIRECT_CONNECT_MS;
+  boot("next reset");
+
+  // The record of other credentials is never used
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw, "newpass1");
+  boot("credentials changed");
+
+  return 0;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
@@ -0,0 +1,73 @@
+// USING_ASYNC_WIFI_SCAN : time from startConfigurationMode() to softAP(), and the SSID list of the page.
+// Build with and without USING_ASYNC_WIFI_SCAN to compare. The times are simulated, not measured :
+// an all-channel WiFi.scanNetworks() takes SCAN_MS
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+#define SCAN_MS       2200
+
+extern unsigned long mockMillis;
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+int main()
+{
+  ESPAsync_WiFiManager_Lite wm;
+
+  WiFi.scanData =
+  {
+    { "net-a", -70, 6,  { 1 }, 3 },
+    { "net-b", -40, 1,  { 2 }, 3 },
+    { "net-a", -50, 11, { 3 }, 3 }
+  };
+
+  // Portal without the STA link, so that run() stays in it
+  WiFi.staStatus  = WL_DISCONNECTED;
+  WiFi.scanSimMs  = SCAN_MS;
+  mockMillis      = 1000;
+
+  const unsigned long t0 = mockMillis;
+  unsigned long tAP = 0;
+
+  WiFi.onSoftAP = [&]() { tAP = mockMillis; };
+
+  wm.setConfigPortal("ap", "12345678");
+  wm.startConfigurationMode();
+
+  String page;
+
+#if USING_ASYNC_WIFI_SCAN
+  wm.renderHTML(page);
+
+  AsyncWebServerRequest running;
+
+  wm.handleScanPoll(&running);
+
+  const bool scanning = (page.indexOf("Scanning...") >= 0) && (running.lastCode == 202);
+
+  // Until the scan is done
+  while ( wm._scanRunning && (mockMillis - t0 < 60000) )
+  {
+    mockMillis += 10;
+    wm.run();
+  }
+#else
+  const bool scanning = false;
+#endif
+
+  wm.renderHTML(page);
+
+  // Sorted by RSSI, duplicates removed
+  const bool list = (page.indexOf("<option>net-b<option>net-a") >= 0);
+
+  printf("  %s : softAP() after %lu ms simulated, \"Scanning...\" while scanning=%d, SSID list after %lu ms simulated=%d\n",
+         USING_ASYNC_WIFI_SCAN ? "async scan" : "blocking scan", tAP - t0, scanning, mockMillis - t0, list);
+
+  return list ? 0 : 1;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
@@ -0,0 +1,105 @@
+// Config Portal page render : renderHTML() from the parsed slot table, against the previous
+// createHTML() + one replace() per placeholder. Both pages must be equal byte for byte
+
+#define USE_DYNAMIC_PARAMETERS    true
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+#include <chrono>
+
+#define MAX_ITEMS     100
+#define RUNS          300
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+static char values[MAX_ITEMS][21];
+
+MenuItem myMenuItems [MAX_ITEMS];
+uint16_t NUM_MENU_ITEMS = 0;
+
+// Previous code of the GET handler
+static String oldRender(ESPAsync_WiFiManager_Lite& wm)
+{
+  String result;
+
+  wm.createHTML(result);
+
+  if (wm.RFC952_hostname[0] != 0)
+    result.replace("ESP_ASYNC_WM_LITE", wm.RFC952_hostname);
+
+  result.replace("[[id]]",  wm.ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid);
+  result.replace("[[pw]]",  wm.ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw);
+  result.replace("[[id1]]", wm.ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid);
+  result.replace("[[pw1]]", wm.ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw);
+  result.replace("[[nm]]",  wm.ESP_WM_LITE_config.board_name);
+
+  for (uint16_t i = 0; i < NUM_MENU_ITEMS; i++)
+    result.replace(String("[[") + myMenuItems[i].id + "]]", myMenuItems[i].pdata);
+
+  return result;
+}
+
+int main()
+{
+  int failures = 0;
+
+  for (int n : { 6, 30, 100 })
+  {
+    NUM_MENU_ITEMS = n;
+
+    for (int i = 0; i < n; i++)
+    {
+      snprintf(myMenuItems[i].id,           sizeof(myMenuItems[i].id),          "p%d", i);
+      snprintf(myMenuItems[i].displayName,  sizeof(myMenuItems[i].displayName), "Param %d", i);
+      snprintf(values[i], sizeof(values[i]), "value-%d", i);
+
+      myMenuItems[i].pdata  = values[i];
+      myMenuItems[i].maxlen = sizeof(values[i]) - 1;
+    }
+
+    ESPAsync_WiFiManager_Lite wm;
+
+    wm.hadConfigData = true;
+    strcpy(wm.RFC952_hostname, "myhost");
+    strcpy(wm.ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, "ssid0");
+    strcpy(wm.ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw,   "password0");
+    strcpy(wm.ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid, "ssid1");
+    strcpy(wm.ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw,   "password1");
+    strcpy(wm.ESP_WM_LITE_config.board_name, "board");
+
+    String oldPage = oldRender(wm);
+    String newPage;
+
+    wm.renderHTML(newPage);
+
+    if (oldPage != newPage)
+      failures++;
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    for (int r = 0; r < RUNS; r++)
+      String page = oldRender(wm);
+
+    const auto t1 = std::chrono::steady_clock::now();
+
+    for (int r = 0; r < RUNS; r++)
+    {
+      String page;
+      wm.renderHTML(page);
+    }
+
+    const auto t2 = std::chrono::steady_clock::now();
+
+    printf("%3d items, %5u B : replace() %7.1f us, slots %5.1f us per page, same=%d\n", n, oldPage.length(),
+           std::chrono::duration<double, std::micro>(t1 - t0).count() / RUNS,
+           std::chrono::duration<double, std::micro>(t2 - t1).count() / RUNS, oldPage == newPage);
+  }
+
+  return failures ? 1 : 0;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
@@ -0,0 +1,55 @@
+#!/bin/bash
+#
+# Host microbenchmarks of the library, against the mocked Arduino / ESP cores of ../host_test.
+# Times are of the host CPU, only the ratios between old and new code are meaningful.
+# Usage : utils/bench/run.sh
+
+cd "$(dirname "$0")"
+
+CXX="g++ -std=gnu++17 -O2 -Wall -Wextra -Wno-cpp -I../host_test/include -I../../src -D_ESP_WM_LITE_LOGLEVEL_=0"
+ESP32="-DESP32=1 -DESP_ARDUINO_VERSION_MAJOR=2"
+ESP8266="-DESP8266=1"
+OUT=$(mktemp -d)
+failed=0
+
+trap 'rm -rf "$OUT"' EXIT
+
+# run <bench> <flags...>
+run()
+{
+  name=$1
+  shift
+
+  echo "== $name $*"
+
+  if ! $CXX "$@" -c ../host_test/stubs.cpp -o "$OUT/stubs.o" || ! $CXX "$@" "$name.cpp" "$OUT/stubs.o" -o "$OUT/$name"; then
+    echo "BUILD FAILED"
+    failed=1
+  elif ! "$OUT/$name"; then
+    failed=1
+  fi
+}
+
+for platform in "$ESP32" "$ESP8266"; do
+  run render_bench $platform
+  run scan_bench $platform
+  run eeprom_bench $platform
+  run run_bench $platform
+  run run_bench $platform -DUSING_NONBLOCKING_CONNECT=true
+  run run_bench $platform -DUSING_WIFI_EVENTS=true
+  run run_bench $platform -DUSING_WIFI_EVENTS=true -DUSING_NONBLOCKING_CONNECT=true
+  run fast_connect_bench $platform
+  run fast_connect_bench $platform -DUSING_NONBLOCKING_CONNECT=true
+  run scan_connect_bench $platform
+  run scan_connect_bench $platform -DUSING_SCAN_CONNECT=true
+  run scan_connect_bench $platform -DUSING_NONBLOCKING_CONNECT=true
+  run scan_connect_bench $platform -DUSING_NONBLOCKING_CONNECT=true -DUSING_SCAN_CONNECT=true
+  run portal_start_bench $platform
+  run portal_start_bench $platform -DUSING_ASYNC_WIFI_SCAN=true
+done
+
+# Table CRC32 of ESP8266, at the default -O2 and at the -Os of the core
+run crc_bench $ESP8266
+run crc_bench $ESP8266 -Os
+
+exit $failed
@@ -0,0 +1,116 @@
+// Cost of run() in a steady connected state, polling WiFi.status() against USING_WIFI_EVENTS,
+// and the simulated time until wifi_connected goes false after the AP drops.
+// millis() is simulated : one run() per simulated ms
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+#include <chrono>
+
+extern unsigned long mockMillis;
+extern bool multiRunFails;
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+static ESPAsync_WiFiManager_Lite* wm;
+
+// statusCostUs : busy wait in each WiFi.status(), as a stand-in for the call into the WiFi driver
+static void timeRun(const int& statusCostUs, const long& runs)
+{
+  WiFi.statusCostUs = statusCostUs;
+
+  const long calls = WiFi.statusCalls;
+  const auto t0    = std::chrono::steady_clock::now();
+
+  for (long i = 0; i < runs; i++)
+  {
+    mockMillis++;
+    wm->run();
+  }
+
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / runs;
+
+  printf("  status() cost %d us : %.2f status() per run(), %.0f ns per run()\n", statusCostUs,
+         (double) (WiFi.statusCalls - calls) / runs, ns);
+
+  WiFi.statusCostUs = 0;
+}
+
+static void linkDown()
+{
+  WiFi.staStatus  = WL_DISCONNECTED;
+  WiFi.staRssi    = 0;
+
+#if USING_WIFI_EVENTS
+#ifdef ESP32
+  WiFi.fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, 8);
+#else
+  WiFiEventStationModeDisconnected event;
+
+  event.reason = 8;
+  WiFi.discCb(event);
+#endif
+#endif
+}
+
+int main()
+{
+  wm  = new ESPAsync_WiFiManager_Lite();
+  drd = new DoubleResetDetector(10, 0);
+
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, "home");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw,   "12345678");
+  wm->hadConfigData = true;
+
+  mockMillis      = 1000;
+  WiFi.staStatus  = WL_CONNECTED;
+  WiFi.staRssi    = -60;
+
+#if USING_WIFI_EVENTS
+  wm->beginWiFiEvents();
+#endif
+
+#if USING_NONBLOCKING_CONNECT
+  wm->connectWiFiStep();
+#endif
+
+  // Past the first status checks
+  for (int i = 0; i < 6000; i++)
+  {
+    mockMillis++;
+    wm->run();
+  }
+
+  if (!wm->wifi_connected)
+  {
+    printf("FAIL : not connected\n");
+    return 1;
+  }
+
+  timeRun(0, 2000000);
+  timeRun(2, 20000);
+
+  // Link loss right after a status check, the worst case of polling. Reconnections fail
+  linkDown();
+  multiRunFails = true;
+
+  const unsigned long t = mockMillis;
+  int runs = 0;
+
+  while ( wm->wifi_connected && (mockMillis - t < 20000) )
+  {
+    mockMillis++;
+    wm->run();
+    runs++;
+  }
+
+  // The simulated time includes the blocking reconnections done inside those run()
+  printf("  wifi_connected false after %d run(), %lu ms simulated\n", runs, mockMillis - t);
+
+  return wm->wifi_connected ? 1 : 0;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
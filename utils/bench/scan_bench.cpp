@@ -0,0 +1,134 @@
+// WiFi scan processing : processWiFiScan() against the previous exchange sort and String dedupe.
+// Synthetic scans with n / 4 distinct SSIDs and random RSSI. The kept (SSID, RSSI) must be the same
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+// Previous sort and dedupe of processWiFiScan()
+static void oldScan(const int& n, int** indicesptr)
+{
+  if (*indicesptr)
+    free(*indicesptr);
+
+  int* indices = (int *) malloc(n * sizeof(int));
+
+  *indicesptr = indices;
+
+  for (int i = 0; i < n; i++)
+    indices[i] = i;
+
+  for (int i = 0; i < n; i++)
+  {
+    for (int j = i + 1; j < n; j++)
+    {
+      if (WiFi.RSSI(indices[j]) > WiFi.RSSI(indices[i]))
+        std::swap(indices[i], indices[j]);
+    }
+  }
+
+  String cssid;
+
+  for (int i = 0; i < n; i++)
+  {
+    if (indices[i] == -1)
+      continue;
+
+    cssid = WiFi.SSID(indices[i]);
+
+    for (int j = i + 1; j < n; j++)
+    {
+      if (cssid == WiFi.SSID(indices[j]))
+        indices[j] = -1;
+    }
+  }
+}
+
+// Kept networks, in a comparable order
+static std::vector<std::pair<int, std::string>> kept(const int& n, const int* indices)
+{
+  std::vector<std::pair<int, std::string>> result;
+
+  for (int i = 0; i < n; i++)
+  {
+    if (indices[i] != -1)
+      result.push_back( { -WiFi.scanData[indices[i]].rssi, WiFi.scanData[indices[i]].ssid } );
+  }
+
+  std::sort(result.begin(), result.end());
+
+  return result;
+}
+
+int main()
+{
+  ESPAsync_WiFiManager_Lite wm;
+  std::mt19937 rng(1);
+
+  int failures = 0;
+
+  for (int n : { 10, 50, 200 })
+  {
+    WiFi.scanData.clear();
+
+    for (int i = 0; i < n; i++)
+    {
+      WiFiClass::ScanEntry entry { "CorpNet-" + std::to_string(rng() % (n / 4 + 1)), -30 - (int) (rng() % 60),
+                                   1 + (int) (rng() % 13), {}, 3 };
+
+      WiFi.scanData.push_back(entry);
+    }
+
+    const int runs = (n == 200) ? 50 : 2000;
+
+    int* oldIndices = NULL;
+    int* newIndices = NULL;
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    for (int r = 0; r < runs; r++)
+      oldScan(n, &oldIndices);
+
+    const auto t1 = std::chrono::steady_clock::now();
+
+    for (int r = 0; r < runs; r++)
+      wm.processWiFiScan(n, &newIndices);
+
+    const auto t2 = std::chrono::steady_clock::now();
+
+    // Calls into the WiFi driver of one pass
+    WiFi.rssiCalls = WiFi.ssidCalls = 0;
+    oldScan(n, &oldIndices);
+
+    const int oldRSSI = WiFi.rssiCalls;
+    const int oldSSID = WiFi.ssidCalls;
+
+    WiFi.rssiCalls = WiFi.ssidCalls = 0;
+    wm.processWiFiScan(n, &newIndices);
+
+    const bool same = (kept(n, oldIndices) == kept(n, newIndices));
+
+    if (!same)
+      failures++;
+
+    printf("n=%3d : old %8.1f us, new %6.1f us, RSSI() %5d -> %3d, SSID() %5d -> %3d, same=%d\n", n,
+           std::chrono::duration<double, std::micro>(t1 - t0).count() / runs,
+           std::chrono::duration<double, std::micro>(t2 - t1).count() / runs,
+           oldRSSI, WiFi.rssiCalls, oldSSID, WiFi.ssidCalls, same);
+
+    free(oldIndices);
+    free(newIndices);
+  }
+
+  return failures ? 1 : 0;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
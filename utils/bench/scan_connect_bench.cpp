@@ -0,0 +1,128 @@
+// USING_SCAN_CONNECT : time to connect and RSSI of the AP joined, in a mesh of 3 nodes of the same SSID.
+// Build with and without USING_SCAN_CONNECT to compare. The times are simulated from a model of the WiFi driver,
+// not measured :
+// - an all-channel scan takes SCAN_MS, a directed association and DHCP ASSOCIATION_MS;
+// - wifiMulti.run() scans then joins the strongest AP, SCAN_MS + ASSOCIATION_MS;
+// - WiFi.begin(ssid) joins the first AP found, on the lowest channel, after FIRST_AP_MS
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+#define SCAN_MS             2200
+#define ASSOCIATION_MS      700
+#define FIRST_AP_MS         850
+
+extern unsigned long mockMillis;
+extern unsigned long multiRunBlockMs;
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+// Nodes of "mesh" on channels 1, 6 and 11, and a stronger other network
+static void setMesh(const int& rssi1, const int& rssi6, const int& rssi11)
+{
+  const int rssi[3]     = { rssi1, rssi6, rssi11 };
+  const int channel[3]  = { 1, 6, 11 };
+
+  WiFi.scanData.clear();
+
+  for (int i = 0; i < 3; i++)
+  {
+    WiFiClass::ScanEntry node { "mesh", rssi[i], channel[i], {}, 3 };
+
+    memset(node.bssid, i + 1, sizeof(node.bssid));
+    WiFi.scanData.push_back(node);
+  }
+
+  WiFiClass::ScanEntry other { "neighbour", -40, 3, {}, 3 };
+
+  memset(other.bssid, 9, sizeof(other.bssid));
+  WiFi.scanData.push_back(other);
+}
+
+// RSSI of the AP joined : by BSSID for a directed connection, else the node on the lowest channel
+static int joinedRSSI()
+{
+  if (WiFi.lastBssid)
+  {
+    for (auto& entry : WiFi.scanData)
+    {
+      if (memcmp(entry.bssid, WiFi.lastBssid, sizeof(entry.bssid)) == 0)
+        return entry.rssi;
+    }
+  }
+
+  return WiFi.scanData[0].rssi;
+}
+
+int main()
+{
+  ESPAsync_WiFiManager_Lite* wm = new ESPAsync_WiFiManager_Lite();
+
+  drd = new DoubleResetDetector(10, 0);
+
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, "mesh");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw,   "12345678");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid, "other");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw,   "12345678");
+  wm->hadConfigData = true;
+
+  setMesh(-85, -60, -72);
+
+  WiFi.scanSimMs    = SCAN_MS;
+  WiFi.directMs     = ASSOCIATION_MS;
+  WiFi.scanBeginMs  = FIRST_AP_MS;
+  multiRunBlockMs   = SCAN_MS + ASSOCIATION_MS;
+
+  WiFi.staStatus    = WL_DISCONNECTED;
+  mockMillis        = 1000;
+
+  const unsigned long t = mockMillis;
+
+#if USING_NONBLOCKING_CONNECT
+  wm->connectWiFiStep();
+
+  while ( (wm->getConnectState() != WM_CONNECT_CONNECTED) && (mockMillis - t < 60000) )
+  {
+    mockMillis += 10;
+    wm->run();
+  }
+
+  // wifiMulti.run() isn't used, the AP is the one of WiFi.begin()
+  const int rssi = joinedRSSI();
+#else
+  wm->connectMultiWiFi();
+
+  // Without scan-connect, wifiMulti.run() joins the strongest node
+  const int rssi = USING_SCAN_CONNECT ? joinedRSSI() : -60;
+#endif
+
+  printf("  %s, %s : connected in %lu ms simulated, to the node at %d dBm\n",
+         USING_NONBLOCKING_CONNECT ? "non-blocking" : "blocking", USING_SCAN_CONNECT ? "scan-connect" : "no scan-connect",
+         mockMillis - t, rssi);
+
+#if USING_SCAN_CONNECT
+  // SCAN_CONNECT_HYSTERESIS : the last AP at -62 dBm stays against -58 dBm, not against -55 dBm
+  ESP_WM_LITE_AP_Candidate ap;
+
+  uint8_t last[6];
+
+  memcpy(last, WiFi.scanData[1].bssid, sizeof(last));
+
+  setMesh(-85, -62, -58);
+  wm->selectScanAP(WiFi.scanData.size(), ap, last, SCAN_CONNECT_HYSTERESIS);
+
+  const int stays = ap.channel;
+
+  setMesh(-85, -62, -55);
+  wm->selectScanAP(WiFi.scanData.size(), ap, last, SCAN_CONNECT_HYSTERESIS);
+
+  printf("  last AP at -62 dBm : against -58 dBm on channel %d, against -55 dBm on channel %d\n", stays, ap.channel);
+#endif
+
+  return (WiFi.status() == WL_CONNECTED) ? 0 : 1;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+#
+# Regenerate src/ESPAsync_WiFiManager_Lite_Assets.h from utils/assets/*
+#
+# Each asset is stored twice in PROGMEM : gzip-compressed, and as plain text for clients
+# not accepting gzip. The ETag / cache-busting version is the CRC32 of the plain text.
+#
+# Usage : python3 utils/gzip_assets.py   (from the library root)
+
+import gzip
+import os
+import zlib
+
+ROOT   = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+ASSETS = os.path.join(ROOT, "utils", "assets")
+OUTPUT = os.path.join(ROOT, "src", "ESPAsync_WiFiManager_Lite_Assets.h")
+
+# (file, C name)
+FILES = [
+  ("wm.css", "ESP_WM_LITE_CSS"),
+  ("wm.js",  "ESP_WM_LITE_JS"),
+]
+
+HEADER = """/****************************************************************************************************************************
+  ESPAsync_WiFiManager_Lite_Assets.h
+  For ESP8266 / ESP32 boards
+
+  ESPAsync_WiFiManager_Lite (https://github.com/khoih-prog/ESPAsync_WiFiManager_Lite) is a library
+  for the ESP32/ESP8266 boards to enable store Credentials in EEPROM/SPIFFS/LittleFS for easy
+  configuration/reconfiguration and autoconnect/autoreconnect of WiFi and other services without Hardcoding.
+
+  Built by Khoi Hoang https://github.com/khoih-prog/ESPAsync_WiFiManager_Lite
+  Licensed under MIT license
+
+  GENERATED by utils/gzip_assets.py from utils/assets/. DO NOT EDIT
+ *****************************************************************************************************************************/
+
+#pragma once
+
+#ifndef ESPAsync_WiFiManager_Lite_Assets_h
+#define ESPAsync_WiFiManager_Lite_Assets_h
+"""
+
+FOOTER = """
+#endif    //ESPAsync_WiFiManager_Lite_Assets_h
+"""
+
+
+def c_string(text):
+  return '"' + text.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n") + '"'
+
+
+def c_bytes(data):
+  lines = []
+
+  for i in range(0, len(data), 16):
+    lines.append("  " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+
+  return "\n".join(lines)
+
+
+def main():
+  out = [HEADER]
+
+  for name, cname in FILES:
+    with open(os.path.join(ASSETS, name), "rb") as f:
+      text = f.read().strip()
+
+    # mtime = 0 to keep output identical between runs
+    gz = gzip.compress(text, compresslevel=9, mtime=0)
+    version = "%08x" % (zlib.crc32(text) & 0xFFFFFFFF)
+
+    out.append("\n//////////////////////////////////////////\n")
+    out.append("// %s : %d bytes, %d bytes gzipped\n\n" % (name, len(text), len(gz)))
+    out.append("#define %s_VERSION      \"%s\"\n" % (cname, version))
+    out.append("#define %s_GZ_LEN       %d\n\n" % (cname, len(gz)))
+    out.append("const char %s[] PROGMEM = %s;\n\n" % (cname, c_string(text.decode("utf-8"))))
+    out.append("const uint8_t %s_GZ[] PROGMEM =\n{\n%s\n};\n" % (cname, c_bytes(gz)))
+
+  out.append(FOOTER)
+
+  with open(OUTPUT, "w", newline="\n") as f:
+    f.write("".join(out))
+
+
+if __name__ == "__main__":
+  main()
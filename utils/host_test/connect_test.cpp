@@ -0,0 +1,211 @@
+// Host simulation of USING_NONBLOCKING_CONNECT : WiFi.status() / RSSI() are driven by hand, millis() is simulated.
+// Each run() must return without any simulated time passing, i.e. without delay()
+
+#define WIFI_RECON_INTERVAL     5000
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+#include <chrono>
+
+extern unsigned long mockMillis;
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+static ESPAsync_WiFiManager_Lite* wm;
+
+static unsigned long  worstSim  = 0;
+static double         worstReal = 0;
+static int            failures  = 0;
+
+#define CHECK(cond)   do { if (!(cond)) { printf("FAIL line %d : %s\n", __LINE__, #cond); failures++; } } while (0)
+
+static void step(const unsigned long& dt = 20)
+{
+  mockMillis += dt;
+
+  const unsigned long t0 = mockMillis;
+  const auto          r0 = std::chrono::steady_clock::now();
+
+  wm->run();
+
+  const double real = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - r0).count();
+
+  if (mockMillis - t0 > worstSim)
+    worstSim = mockMillis - t0;
+
+  if (real > worstReal)
+    worstReal = real;
+}
+
+static void linkDown()
+{
+  WiFi.staStatus  = WL_DISCONNECTED;
+  WiFi.staRssi    = 0;
+
+#if USING_WIFI_EVENTS
+#ifdef ESP32
+  WiFi.fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, 201);
+#else
+  WiFi.discCb(WiFiEventStationModeDisconnected());
+#endif
+#endif
+}
+
+static void linkUp()
+{
+  WiFi.staRssi    = -60;
+  WiFi.staStatus  = WL_CONNECTED;
+
+#if USING_WIFI_EVENTS
+#ifdef ESP32
+  WiFi.fire(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+#else
+  WiFi.gotIPCb(WiFiEventStationModeGotIP());
+#endif
+#endif
+}
+
+int main()
+{
+  wm  = new ESPAsync_WiFiManager_Lite();
+  drd = new DoubleResetDetector(10, 0);
+
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, "gone");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw,   "12345678");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[1].wifi_ssid, "home");
+  strcpy(wm->ESP_WM_LITE_config.WiFi_Creds[1].wifi_pw,   "12345678");
+  wm->hadConfigData = true;
+
+#if USING_WIFI_EVENTS
+  wm->beginWiFiEvents();
+#endif
+
+  linkDown();
+  mockMillis = 1000;
+
+  // Stored credentials : the first AP is missing, the second one is tried after TIMEOUT_RECONNECT_WIFI
+  wm->connectWiFiStep();
+  CHECK(wm->getConnectState() == WM_CONNECT_CONNECTING);
+  CHECK(WiFi.lastBegin == "gone");
+
+  unsigned long t = mockMillis;
+
+  while ( (WiFi.lastBegin != "home") && (mockMillis - t < 60000) )
+    step();
+
+  printf("switched to 'home' after %lu ms\n", mockMillis - t);
+  CHECK(WiFi.lastBegin == "home");
+
+  WiFi.staRssi = -60;
+  step();
+  CHECK(wm->getConnectState() == WM_CONNECT_WAITING_IP);
+
+  linkUp();
+  step();
+  CHECK(wm->getConnectState() == WM_CONNECT_CONNECTED);
+  CHECK(wm->getConnectIndex() == 1);
+
+  for (int i = 0; i < 500; i++)
+    step();
+
+  // Link lost : no WiFi.begin() before WIFI_RECON_INTERVAL
+  linkDown();
+
+  int begins = WiFi.beginCalls;
+
+  step();
+  CHECK(wm->getConnectState() == WM_CONNECT_BACKOFF);
+
+  t = mockMillis;
+
+  while ( (WiFi.beginCalls == begins) && (mockMillis - t < 60000) )
+    step();
+
+  printf("reconnection started %lu ms after the loss\n", mockMillis - t);
+  CHECK(mockMillis - t >= WIFI_RECON_INTERVAL - 20);
+
+  linkUp();
+  step();
+  CHECK(wm->getConnectState() == WM_CONNECT_CONNECTED);
+
+  // Both APs missing : a pass fails, then it backs off
+  linkDown();
+  step();
+
+  t = mockMillis;
+
+  while ( (wm->getConnectState() == WM_CONNECT_BACKOFF) && (mockMillis - t < 120000) )
+    step();
+
+  t = mockMillis;
+
+  while ( (wm->getConnectState() != WM_CONNECT_BACKOFF) && (mockMillis - t < 120000) )
+    step();
+
+  printf("pass over both APs failed after %lu ms, config mode %d\n", mockMillis - t, wm->configuration_mode);
+  CHECK(wm->getConnectState() == WM_CONNECT_BACKOFF);
+  CHECK(!wm->configuration_mode);
+
+  printf("worst run() : %lu ms simulated, %.1f us real\n", worstSim, worstReal);
+  CHECK(worstSim == 0);
+
+  // First boot, nothing reachable : Config Portal. Its AP start has its own short delay(), not counted
+  ESPAsync_WiFiManager_Lite boot;
+
+  boot.hadConfigData      = true;
+  boot.ESP_WM_LITE_config = wm->ESP_WM_LITE_config;
+
+  wm = &boot;
+
+#if USING_WIFI_EVENTS
+  boot.beginWiFiEvents();
+#endif
+
+  boot.connectWiFiStep();
+
+  t = mockMillis;
+
+  while ( !boot.configuration_mode && (mockMillis - t < 120000) )
+    step();
+
+  printf("first boot failed -> config mode after %lu ms\n", mockMillis - t);
+  CHECK(boot.configuration_mode);
+
+  // begin(ssid, pass) : only starts, run() does the rest
+  ESPAsync_WiFiManager_Lite direct;
+
+  wm        = &direct;
+  worstSim  = 0;
+
+  t = mockMillis;
+  direct.begin("lab", "12345678");
+
+  CHECK(mockMillis == t);
+  CHECK(direct.getConnectState() == WM_CONNECT_CONNECTING);
+  CHECK(WiFi.lastBegin == "lab");
+
+  for (int i = 0; i < 100; i++)
+    step();
+
+  linkUp();
+  step();
+  CHECK(direct.getConnectState() == WM_CONNECT_CONNECTED);
+  CHECK(worstSim == 0);
+
+  // Open network
+  ESPAsync_WiFiManager_Lite open;
+
+  linkDown();
+  open.begin("cafe", NULL);
+  CHECK(WiFi.lastBegin == "cafe");
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+
+  return failures ? 1 : 0;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
@@ -0,0 +1,84 @@
+// Host test of the EEPROM storage : loads and unchanged saves must not mark the EEPROM to write by next commit()
+
+#define USE_LITTLEFS              false
+#define USE_SPIFFS                false
+#define USE_DYNAMIC_PARAMETERS    true
+#define USING_WRITE_AVOIDANCE     true
+
+#define private public
+#include <ESPAsync_WiFiManager_Lite.h>
+
+bool LOAD_DEFAULT_CONFIG_DATA = false;
+ESP_WM_LITE_Configuration defaultConfig;
+
+#define NUM_ITEMS     3
+
+static char values[NUM_ITEMS][33];
+
+MenuItem myMenuItems [NUM_ITEMS];
+uint16_t NUM_MENU_ITEMS = NUM_ITEMS;
+
+static int failures = 0;
+
+#define CHECK(cond)   do { if (!(cond)) { printf("FAIL line %d : %s\n", __LINE__, #cond); failures++; } } while (0)
+
+int main()
+{
+  ESPAsync_WiFiManager_Lite wm;
+
+  for (int i = 0; i < NUM_ITEMS; i++)
+  {
+    snprintf(values[i], sizeof(values[i]), "value-%d", i);
+    myMenuItems[i] = { "p", "P", values[i], sizeof(values[i]) - 1 };
+  }
+
+  strcpy(wm.ESP_WM_LITE_config.header, ESP_WM_LITE_BOARD_TYPE);
+  strcpy(wm.ESP_WM_LITE_config.WiFi_Creds[0].wifi_ssid, "home");
+  strcpy(wm.ESP_WM_LITE_config.WiFi_Creds[0].wifi_pw,   "12345678");
+
+  EEPROM.begin(EEPROM_SIZE);
+
+  wm.saveAllConfigData();
+  CHECK(EEPROM.commits == 1);
+  CHECK(!EEPROM._dirty);
+
+  // Loads
+  strcpy(values[1], "changed in RAM");
+
+  CHECK(wm.checkDynamicData());
+  CHECK(wm.EEPROM_getDynamicData());
+  CHECK(strcmp(values[1], "value-1") == 0);
+  CHECK(!EEPROM._dirty);
+
+  // Unchanged saves are skipped, without marking the EEPROM
+  wm.saveAllConfigData();
+  wm.saveConfigData();
+  wm.clearForcedCP();
+  CHECK(EEPROM.commits == 1);
+  CHECK(!EEPROM._dirty);
+
+  // Changed dynamic data is written
+  strcpy(values[2], "new");
+  wm.saveAllConfigData();
+  CHECK(EEPROM.commits == 2);
+
+  strcpy(values[2], "lost");
+  CHECK(wm.EEPROM_getDynamicData());
+  CHECK(strcmp(values[2], "new") == 0);
+
+  // Corrupted dynamic data is rejected, pdata kept
+  EEPROM.buf[wm.EEPROM_dynamicDataOffset() + 1] ^= 0x55;
+  strcpy(values[0], "kept");
+
+  CHECK(!wm.checkDynamicData());
+  CHECK(!wm.EEPROM_getDynamicData());
+  CHECK(strcmp(values[0], "kept") == 0);
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+
+  return failures ? 1 : 0;
+}
+
+// Arduino sketch entry points, unused
+void setup() {}
+void loop() {}
@@ -0,0 +1,162 @@
+#pragma once
+#include <chrono>
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <string>
+#include <type_traits>
+#include <functional>
+typedef uint8_t byte;
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper*>(p))
+#define HEX 16
+#define DEC 10
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define ARDUINO_BOARD "ESP32_DEV"
+inline size_t strlen_P(const char* s) { return strlen(s); }
+inline void* memcpy_P(void* d, const void* s, size_t n) { return memcpy(d, s, n); }
+inline char* strncpy_P(char* d, const char* s, size_t n) { return strncpy(d, s, n); }
+inline char* strcpy_P(char* d, const char* s) { return strcpy(d, s); }
+inline int strcmp_P(const char* a, const char* b) { return strcmp(a, b); }
+inline int strncmp_P(const char* a, const char* b, size_t n) { return strncmp(a, b, n); }
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long);
+void yield();
+void pinMode(int, int);
+void digitalWrite(int, int);
+long random(long);
+long random(long, long);
+void randomSeed(unsigned long);
+class String {
+ public:
+  std::string s;
+  String() {}
+  String(const char* c) : s(c ? c : "") {}
+  String(const std::string& c) : s(c) {}
+  String(const __FlashStringHelper* c) : s((const char*)c) {}
+  String(char c) : s(1, c) {}
+  String(int v, int base = 10) { char b[40]; snprintf(b, 40, base == 16 ? "%x" : "%d", v); s = b; }
+  String(unsigned int v, int base = 10) { char b[40]; snprintf(b, 40, base == 16 ? "%x" : "%u", v); s = b; }
+  String(long v, int base = 10) { char b[40]; snprintf(b, 40, base == 16 ? "%lx" : "%ld", v); s = b; }
+  String(unsigned long v, int base = 10) { char b[40]; snprintf(b, 40, base == 16 ? "%lx" : "%lu", v); s = b; }
+  const char* c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.size(); }
+  bool reserve(unsigned int n) { s.reserve(n); return true; }
+  void toUpperCase() { for (auto& c : s) c = toupper(c); }
+  void replace(const String& a, const String& b) { size_t p = 0; while ((p = s.find(a.s, p)) != std::string::npos) { s.replace(p, a.s.size(), b.s); p += b.s.size(); } }
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* o) { s += o; return *this; }
+  String& operator+=(char o) { s += o; return *this; }
+  String& operator+=(int o) { s += std::to_string(o); return *this; }
+  String& operator+=(unsigned int o) { s += std::to_string(o); return *this; }
+  String& operator+=(long o) { s += std::to_string(o); return *this; }
+  String& operator+=(unsigned long o) { s += std::to_string(o); return *this; }
+  String& operator+=(const __FlashStringHelper* o) { s += (const char*)o; return *this; }
+  bool concat(const char* o, unsigned int n) { s.append(o, n); return true; }
+  bool concat(const char* o) { s += o; return true; }
+  bool concat(char o) { s += o; return true; }
+  bool concat(const String& o) { s += o.s; return true; }
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator==(const char* o) const { return s == o; }
+  bool operator!=(const String& o) const { return s != o.s; }
+  bool operator!=(const char* o) const { return s != o; }
+  char operator[](unsigned int i) const { return s[i]; }
+  int indexOf(char c) const { auto p = s.find(c); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const char* c) const { auto p = s.find(c); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const String& c) const { auto p = s.find(c.s); return p == std::string::npos ? -1 : (int)p; }
+  String substring(unsigned a, unsigned b) const { return String(s.substr(a, b - a)); }
+  String substring(unsigned a) const { return String(s.substr(a)); }
+  long toInt() const { return atol(s.c_str()); }
+  bool startsWith(const String& p) const { return s.rfind(p.s, 0) == 0; }
+  bool endsWith(const String& p) const { return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0; }
+  void trim() {}
+  bool isEmpty() const { return s.empty(); }
+};
+inline String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+inline String operator+(const String& a, const char* b) { return String(a.s + b); }
+inline String operator+(const char* a, const String& b) { return String(a + b.s); }
+inline String operator+(const String& a, const __FlashStringHelper* b) { return String(a.s + (const char*)b); }
+inline bool operator==(const char* a, const String& b) { return b == a; }
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) { return 1; }
+  virtual size_t write(const uint8_t*, size_t n) { return n; }
+  size_t write(const char* b, size_t n) { return write((const uint8_t*)b, n); }
+  size_t print(const char* c) { return write(c, strlen(c)); }
+  size_t print(const __FlashStringHelper* c) { return print((const char*)c); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(const String& c) { return print(c.c_str()); }
+  template<typename T> size_t print(const T& v) { if constexpr (std::is_arithmetic<T>::value) return print(std::to_string(v).c_str()); else return print((const char*)v); }
+  template<typename T> size_t print(const T&, int) { return 0; }
+  template<typename T> size_t println(const T&) { return 0; }
+  template<typename T> size_t println(const T&, int) { return 0; }
+  size_t println() { return 0; }
+  size_t printf(const char*, ...) { return 0; }
+};
+class Stream : public Print {
+ public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  size_t readBytes(char* b, size_t n) { memset(b, 0, n); return n; }
+  size_t readBytes(uint8_t* b, size_t n) { memset(b, 0, n); return n; }
+};
+class HardwareSerial : public Stream { public: void begin(int) {} operator bool() { return true; } };
+extern HardwareSerial Serial;
+class IPAddress {
+ public:
+  uint8_t b[4];
+  IPAddress() { memset(b, 0, 4); }
+  IPAddress(uint8_t a, uint8_t c, uint8_t d, uint8_t e) { b[0]=a; b[1]=c; b[2]=d; b[3]=e; }
+  IPAddress(uint32_t v) { memcpy(b, &v, 4); }
+  operator uint32_t() const { uint32_t v; memcpy(&v, b, 4); return v; }
+  uint8_t operator[](int i) const { return b[i]; }
+  uint8_t& operator[](int i) { return b[i]; }
+  bool operator==(const IPAddress& o) const { return memcmp(b, o.b, 4) == 0; }
+  bool operator!=(const IPAddress& o) const { return !(*this == o); }
+  bool operator==(uint32_t v) const { return (uint32_t)*this == v; }
+  String toString() const { return String("0.0.0.0"); }
+  bool fromString(const char*) { return true; }
+};
+#define INADDR_NONE IPAddress(0,0,0,0)
+class EspClass {
+ public:
+  uint64_t getEfuseMac() { return 0x123456789ABCULL; }
+  uint32_t getChipId() { return 0x123456; }
+  int restarts = 0; void restart() { restarts++; }
+  void reset() { restarts++; }
+  uint32_t getFreeHeap() { return 0; }
+  // 512 bytes of RTC user memory, offset in 4-byte blocks, power-on garbage
+  uint8_t rtcMem[512]; EspClass() { memset(rtcMem, 0xA5, sizeof(rtcMem)); }
+  bool rtcUserMemoryRead(uint32_t o, uint32_t* d, size_t s) { if (o * 4 + s > sizeof(rtcMem)) return false; memcpy(d, rtcMem + o * 4, s); return true; }
+  bool rtcUserMemoryWrite(uint32_t o, uint32_t* d, size_t s) { if (o * 4 + s > sizeof(rtcMem)) return false; memcpy(rtcMem + o * 4, d, s); return true; }
+};
+extern EspClass ESP;
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#ifndef RTC_NOINIT_ATTR
+#define RTC_NOINIT_ATTR
+#endif
+#if defined(ESP32)
+#include <mutex>
+typedef std::recursive_mutex* SemaphoreHandle_t;
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define pdTRUE 1
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new std::recursive_mutex(); }
+inline int xSemaphoreTakeRecursive(SemaphoreHandle_t m, unsigned long) { m->lock(); return pdTRUE; }
+inline int xSemaphoreGiveRecursive(SemaphoreHandle_t m) { m->unlock(); return pdTRUE; }
+inline void vSemaphoreDelete(SemaphoreHandle_t m) { delete m; }
+#endif
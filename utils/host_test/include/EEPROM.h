@@ -0,0 +1,24 @@
+#pragma once
+#include <Arduino.h>
+// Out-of-line, bounds-checked read()/write() like the ESP8266/ESP32 cores
+class EEPROMClass {
+ public:
+  uint8_t buf[4096];
+  size_t _size = 2048;
+  bool _dirty = false;
+  bool begin(size_t s) { _size = s; return true; }
+  __attribute__((noinline)) uint8_t read(int a) { if (a < 0 || (size_t)a >= _size) return 0; return buf[a]; }
+  __attribute__((noinline)) void write(int a, uint8_t v) { if (a < 0 || (size_t)a >= _size) return; if (buf[a] != v) { buf[a] = v; _dirty = true; } }
+  template<typename T> T& get(int a, T& t) { if (a < 0 || a + sizeof(T) > _size) return t; memcpy((void*)&t, buf + a, sizeof(T)); return t; }
+  template<typename T> const T& put(int a, const T& t) { if (a < 0 || a + sizeof(T) > _size) return t; memcpy(buf + a, (const void*)&t, sizeof(T)); _dirty = true; return t; }
+  int commits = 0;
+  bool commit() { commits++; _dirty = false; return true; }
+  uint8_t* getDataPtr() { _dirty = true; return buf; }
+#ifdef ESP8266
+  const uint8_t* getConstDataPtr() const { return buf; }
+#else
+  size_t readBytes(int a, void* v, size_t n) { if (a < 0 || a + n > _size) return 0; memcpy(v, buf + a, n); return n; }
+#endif
+  size_t length() { return _size; }
+};
+extern EEPROMClass EEPROM;
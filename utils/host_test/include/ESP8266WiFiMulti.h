@@ -0,0 +1,4 @@
+#pragma once
+#include <ESP8266WiFi.h>
+extern unsigned long mockMillis; extern unsigned long multiRunBlockMs; extern bool multiRunFails;
+class ESP8266WiFiMulti { public: bool addAP(const char*, const char* = NULL) { return true; } wl_status_t run(uint32_t = 5000) { mockMillis += multiRunBlockMs; if (multiRunFails) return WL_DISCONNECTED; WiFi.connectAt = 0; WiFi.staStatus = WL_CONNECTED; return WL_CONNECTED; } };
@@ -0,0 +1,3 @@
+#pragma once
+#include <Arduino.h>
+class AsyncDNSServer { public: bool start(uint16_t, const String&, const IPAddress&) { return true; } void stop() {} };
@@ -0,0 +1,87 @@
+#pragma once
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+typedef enum { HTTP_GET = 0b00000001, HTTP_POST = 0b00000010, HTTP_DELETE = 0b00000100, HTTP_PUT = 0b00001000,
+               HTTP_PATCH = 0b00010000, HTTP_HEAD = 0b00100000, HTTP_OPTIONS = 0b01000000, HTTP_ANY = 0b01111111 } WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+class AsyncWebServerRequest;
+class AsyncWebServerResponse {
+ public:
+  virtual ~AsyncWebServerResponse() {}
+  void addHeader(const String& n, const String& v) { headers.push_back(n.s + ": " + v.s); }
+  std::vector<std::string> headers; int code = 200;
+  void setCode(int c) { code = c; }
+  void setContentLength(size_t) {}
+  void setContentType(const String&) {}
+};
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+ public:
+  size_t write(const uint8_t* d, size_t n) override { out.append((const char*)d, n); return n; }
+  size_t write(uint8_t c) override { out += (char)c; return 1; }
+  std::string out;
+  using Print::write;
+};
+class AsyncWebHeader { public: const String& name() const { return n; } const String& value() const { return v; } String n, v; };
+class AsyncWebParameter { public: const String& name() const { return n; } const String& value() const { return v; } bool isPost() const { return true; } String n, v; };
+typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
+typedef std::function<String(const String&)> AwsTemplateProcessor;
+typedef std::function<void(void)> ArDisconnectHandler;
+class AsyncWebServerRequest {
+ public:
+  void* _tempObject = nullptr;
+  const String& arg(const String&) const { return e; }
+  const String& arg(const char* n) const { auto p = getParam(String(n)); return p ? p->v : e; }
+  const String& arg(size_t) const { return e; }
+  const String& argName(size_t) const { return e; }
+  size_t args() const { return 0; }
+  bool hasArg(const char*) const { return false; }
+  bool hasParam(const String& n, bool = false, bool = false) const { return getParam(n) != nullptr; }
+  AsyncWebParameter* getParam(const String& n, bool = false, bool = false) const { for (auto& p : ps) if (p.n == n) return const_cast<AsyncWebParameter*>(&p); return nullptr; }
+  std::vector<AsyncWebParameter> ps; int lastCode = 0; String lastBody;
+  bool hasHeader(const String&) const { return false; }
+  bool hasHeader(const __FlashStringHelper*) const { return false; }
+  AsyncWebHeader* getHeader(const String& n) const { for (auto& h : hs) if (h.n == n) return const_cast<AsyncWebHeader*>(&h); return nullptr; }
+  AsyncWebHeader* getHeader(const __FlashStringHelper* n) const { return getHeader(String(n)); }
+  std::vector<AsyncWebHeader> hs;
+  const String& header(const char*) const { return e; }
+  size_t params() const { return 0; }
+  AsyncWebParameter* getParam(size_t) const { return nullptr; }
+  const String& url() const { return e; }
+  const String& host() const { return e; }
+  WebRequestMethodComposite method() const { return HTTP_GET; }
+  size_t contentLength() const { return 0; }
+  std::vector<std::string> lastHeaders;
+  void send(AsyncWebServerResponse* r) { lastCode = r->code; lastHeaders = r->headers; if (r == lastStream) lastBody = lastStream->out.c_str(), lastStream = nullptr; delete r; }
+  void send(int c, const String& = String(), const String& b = String()) { lastCode = c; lastBody = b; }
+  void send_P(int, const String&, const uint8_t*, size_t, AwsTemplateProcessor = nullptr) {}
+  void send_P(int, const String&, PGM_P, AwsTemplateProcessor = nullptr) {}
+  void redirect(const String&) {}
+  AsyncWebServerResponse* beginResponse(int c, const String& = String(), const String& b = String(), AwsTemplateProcessor = nullptr) { auto r = new AsyncWebServerResponse(); r->code = c; lastBody = b; return r; }
+  AsyncWebServerResponse* beginResponse_P(int c, const String&, const uint8_t*, size_t n, AwsTemplateProcessor = nullptr) { auto r = new AsyncWebServerResponse(); r->code = c; lastLen = n; return r; }
+  AsyncWebServerResponse* beginResponse_P(int c, const String&, PGM_P b, AwsTemplateProcessor = nullptr) { auto r = new AsyncWebServerResponse(); r->code = c; lastBody = b; return r; }
+  AsyncWebServerResponse* beginResponse(const String&, size_t len, AwsResponseFiller f, AwsTemplateProcessor = nullptr) { lastFiller = f; lastLen = len; return new AsyncWebServerResponse(); }
+  AwsResponseFiller lastFiller; size_t lastLen = 0;
+  AsyncWebServerResponse* beginChunkedResponse(const String&, AwsResponseFiller f, AwsTemplateProcessor = nullptr) { lastFiller = f; return new AsyncWebServerResponse(); }
+  AsyncResponseStream* beginResponseStream(const String&, size_t = 1460) { return lastStream = new AsyncResponseStream(); }
+  AsyncResponseStream* lastStream = nullptr;
+  void onDisconnect(ArDisconnectHandler) {}
+  String e;
+};
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> ArBodyHandlerFunction;
+class AsyncCallbackWebHandler {};
+class AsyncWebServer {
+ public:
+  AsyncWebServer(uint16_t) {}
+  void begin() {}
+  void end() {}
+  void reset() {}
+  AsyncCallbackWebHandler& on(const char*, ArRequestHandlerFunction) { return h; }
+  AsyncCallbackWebHandler& on(const char*, WebRequestMethodComposite, ArRequestHandlerFunction) { return h; }
+  AsyncCallbackWebHandler& on(const char*, WebRequestMethodComposite, ArRequestHandlerFunction, ArUploadHandlerFunction) { return h; }
+  AsyncCallbackWebHandler& on(const char*, WebRequestMethodComposite, ArRequestHandlerFunction, ArUploadHandlerFunction, ArBodyHandlerFunction) { return h; }
+  void onNotFound(ArRequestHandlerFunction) {}
+  AsyncCallbackWebHandler h;
+};
@@ -0,0 +1,4 @@
+#pragma once
+#define ESP_DOUBLE_RESET_DETECTOR_VERSION "x"
+#define FLAG_DATA_SIZE 4
+class DoubleResetDetector { public: DoubleResetDetector(int, int) {} bool detectDoubleReset() { return false; } void loop() {} void stop() {} };
@@ -0,0 +1,7 @@
+#pragma once
+#define ESP_MULTI_RESET_DETECTOR_VERSION "x"
+#define FLAG_DATA_SIZE 4
+#ifndef MRD_ADDRESS
+#define MRD_ADDRESS 0
+#endif
+class MultiResetDetector { public: MultiResetDetector(int, int) {} bool detectMultiReset() { return false; } void loop() {} void stop() {} };
@@ -0,0 +1,40 @@
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+inline std::map<std::string, std::vector<uint8_t>> mockFiles;
+inline int mockFileOpensW = 0, mockFileOpensR = 0, mockFileReads = 0;
+class File : public Stream {
+ public:
+  std::vector<uint8_t>* data = nullptr;
+  size_t pos = 0;
+  operator bool() const { return data != nullptr; }
+  void close() { data = nullptr; }
+  size_t size() const { return data ? data->size() : 0; }
+  size_t position() const { return pos; }
+  bool seek(uint32_t p, SeekMode = SeekSet) { pos = p; return true; }
+  size_t read(uint8_t* b, size_t n) { mockFileReads++; size_t k = 0; while (k < n && pos < size()) b[k++] = (*data)[pos++]; return k; }
+  size_t readBytes(char* b, size_t n) { return read((uint8_t*)b, n); }
+  size_t readBytes(uint8_t* b, size_t n) { return read(b, n); }
+  int available() override { return (int)(size() - pos); }
+  int read() override { return pos < size() ? (*data)[pos++] : -1; }
+  size_t write(uint8_t v) override { return write(&v, 1); }
+  size_t write(const uint8_t* b, size_t n) override { if (!data) return 0; data->insert(data->end(), b, b + n); pos += n; return n; }
+  void flush() {}
+  using Print::write;
+};
+class FS {
+ public:
+  File open(const char* n, const char* m = "r") { File f; if (m[0] == 'w') { mockFileOpensW++; mockFiles[n].clear(); f.data = &mockFiles[n]; } else { auto it = mockFiles.find(n); if (it != mockFiles.end()) { mockFileOpensR++; f.data = &it->second; } } return f; }
+  File open(const String& n, const char* m = "r") { return open(n.c_str(), m); }
+  bool exists(const char* n) { return mockFiles.count(n) > 0; }
+  bool remove(const char* n) { return mockFiles.erase(n) > 0; }
+  bool rename(const char* a, const char* b) { auto it = mockFiles.find(a); if (it == mockFiles.end()) return false; mockFiles[b] = it->second; mockFiles.erase(a); return true; }
+  bool begin(bool = false) { return true; }
+  bool format() { mockFiles.clear(); return true; }
+  void end() {}
+};
+typedef FS fs_FS;
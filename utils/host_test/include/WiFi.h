@@ -0,0 +1,84 @@
+#pragma once
+#include <Arduino.h>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <unistd.h>
+#include <string>
+extern unsigned long mockMillis;
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_SCAN_COMPLETED = 2, WL_CONNECTED = 3,
+               WL_CONNECT_FAILED = 4, WL_CONNECTION_LOST = 5, WL_DISCONNECTED = 6, WL_WRONG_PASSWORD = 6 } wl_status_t;
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+#define WIFI_SCAN_RUNNING   (-1)
+#define WIFI_SCAN_FAILED    (-2)
+#ifdef ESP32
+typedef enum { ARDUINO_EVENT_WIFI_READY = 0, ARDUINO_EVENT_WIFI_STA_CONNECTED, ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+               ARDUINO_EVENT_WIFI_STA_GOT_IP, ARDUINO_EVENT_WIFI_STA_LOST_IP, ARDUINO_EVENT_MAX } arduino_event_id_t;
+typedef struct { uint8_t ssid[32]; uint8_t ssid_len; uint8_t bssid[6]; uint8_t reason; } wifi_event_sta_disconnected_t;
+typedef union { wifi_event_sta_disconnected_t wifi_sta_disconnected; } arduino_event_info_t;
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+typedef size_t wifi_event_id_t;
+typedef arduino_event_id_t WiFiEvent_t;
+typedef arduino_event_info_t WiFiEventInfo_t;
+#endif
+struct WiFiEventStationModeGotIP { IPAddress ip, mask, gw; };
+struct WiFiEventStationModeDisconnected { String ssid; uint8_t bssid[6]; int reason; };
+struct WiFiEventHandlerOpaque {};
+typedef std::shared_ptr<WiFiEventHandlerOpaque> WiFiEventHandler;
+class WiFiClass {
+ public:
+  bool mode(wifi_mode_t m) { curMode = m; return true; }
+  wifi_mode_t getMode() { return curMode; }
+  wl_status_t staStatus = WL_CONNECTED; int32_t staRssi = 0; int beginCalls = 0; std::string lastBegin;
+  long directMs = -1, scanBeginMs = -1, dhcpMs = 0; unsigned long connectAt = 0; const uint8_t* lastBssid = NULL; uint8_t lastBssidCopy[6]; int32_t lastChannel = 0;
+  long statusCalls = 0; int statusCostUs = 0;
+  wl_status_t status() { statusCalls++; if (statusCostUs) { auto t0 = std::chrono::steady_clock::now(); while (std::chrono::steady_clock::now() - t0 < std::chrono::microseconds(statusCostUs)); } if (connectAt) return millis() >= connectAt ? WL_CONNECTED : WL_DISCONNECTED; return staStatus; }
+  wl_status_t begin(const char* s, const char* = NULL, int32_t ch = 0, const uint8_t* b = NULL, bool = true) { beginCalls++; lastBegin = s; if (b) memcpy(lastBssidCopy, b, 6); lastBssid = b ? lastBssidCopy : NULL; lastChannel = ch; long d = staticIP ? 0 : dhcpMs; if (!staticIP) { staIP = dhcpIP; staGW = IPAddress(192,168,1,1); staSN = IPAddress(255,255,255,0); } if (directMs >= 0 && b) connectAt = millis() + directMs + d; else if (scanBeginMs >= 0 && !b) connectAt = millis() + scanBeginMs + d; return status(); }
+  IPAddress staIP, staGW, staSN, dhcpIP; int configCalls = 0; bool staticIP = false;
+  bool config(IPAddress ip, IPAddress gw, IPAddress sn, IPAddress = IPAddress(), IPAddress = IPAddress()) { configCalls++; staticIP = (uint32_t) ip != 0; if (staticIP) { staIP = ip; staGW = gw; staSN = sn; } else staIP = dhcpIP; return true; }
+  bool setHostname(const char*) { return true; }
+  bool hostname(const char*) { return true; }
+  struct ScanEntry { std::string ssid; int32_t rssi; int32_t ch; uint8_t bssid[6]; uint8_t enc; };
+  std::vector<ScanEntry> scanData; int16_t scanState = WIFI_SCAN_FAILED; int scanCalls = 0, rssiCalls = 0, ssidCalls = 0;
+  wifi_mode_t curMode = WIFI_STA;
+  long scanSimMs = 0; unsigned long scanDoneAt = 0;
+  int16_t scanNetworks(bool async = false, bool = false, bool = false, uint32_t = 300, uint8_t = 0) { scanCalls++; if (!async) mockMillis += scanSimMs; else scanDoneAt = mockMillis + scanSimMs; if (!async && scanBlockMs) usleep(scanBlockMs * 1000); if (async) { scanState = WIFI_SCAN_RUNNING; return WIFI_SCAN_RUNNING; } scanState = scanData.size(); return scanState; }
+  int16_t scanComplete() { if (scanState == WIFI_SCAN_RUNNING && mockMillis >= scanDoneAt) scanState = scanData.size(); return scanState; }
+  void scanDelete() { scanState = WIFI_SCAN_FAILED; }
+  String SSID(uint8_t i) { ssidCalls++; return i < scanData.size() ? String(scanData[i].ssid.c_str()) : String(); }
+  String SSID() { return String(lastBegin.empty() ? "office" : lastBegin.c_str()); }
+  int32_t RSSI(uint8_t i) { rssiCalls++; return i < scanData.size() ? scanData[i].rssi : 0; }
+  int32_t RSSI() { return staRssi; }
+  int32_t channel(uint8_t i) { return i < scanData.size() ? scanData[i].ch : 1; }
+  int32_t channel() { return 6; }
+  uint8_t* BSSID(uint8_t i) { return i < scanData.size() ? scanData[i].bssid : bssid; }
+  uint8_t* BSSID() { return bssid; }
+  String BSSIDstr() { return String(); }
+  uint8_t encryptionType(uint8_t i) { return i < scanData.size() ? scanData[i].enc : 0; }
+  IPAddress localIP() { return staIP; }
+  IPAddress gatewayIP() { return staGW; }
+  IPAddress subnetMask() { return staSN; }
+  IPAddress dnsIP(uint8_t = 0) { return IPAddress(); }
+  std::function<void()> onSoftAP; int scanBlockMs = 0;
+  int apChannel = 0; bool softAP(const char*, const char* = NULL, int c = 1, int = 0, int = 4) { apChannel = c; if (onSoftAP) onSoftAP(); return true; }
+  bool softAPConfig(IPAddress, IPAddress, IPAddress) { return true; }
+  bool softAPdisconnect(bool = false) { return true; }
+  bool disconnect(bool = false) { connectAt = 0; return true; }
+  bool reconnect() { return true; }
+  bool setAutoReconnect(bool) { return true; }
+  bool isConnected() { return true; }
+  String macAddress() { return String(); }
+#ifdef ESP32
+  std::vector<std::pair<WiFiEventFuncCb, arduino_event_id_t>> evCbs;
+  wifi_event_id_t onEvent(WiFiEventFuncCb cb, arduino_event_id_t id = ARDUINO_EVENT_MAX) { evCbs.push_back({cb, id}); return evCbs.size(); }
+  void fire(arduino_event_id_t id, uint8_t reason = 0) { arduino_event_info_t info; info.wifi_sta_disconnected.reason = reason; for (auto& e : evCbs) if (e.second == id || e.second == ARDUINO_EVENT_MAX) e.first(id, info); }
+  void removeEvent(wifi_event_id_t) {}
+#else
+  std::function<void(const WiFiEventStationModeGotIP&)> gotIPCb; std::function<void(const WiFiEventStationModeDisconnected&)> discCb;
+  WiFiEventHandler onStationModeGotIP(std::function<void(const WiFiEventStationModeGotIP&)> f) { gotIPCb = f; return std::make_shared<WiFiEventHandlerOpaque>(); }
+  WiFiEventHandler onStationModeDisconnected(std::function<void(const WiFiEventStationModeDisconnected&)> f) { discCb = f; return std::make_shared<WiFiEventHandlerOpaque>(); }
+#endif
+  uint8_t bssid[6];
+};
+extern WiFiClass WiFi;
+class WiFiClient {};
@@ -0,0 +1,3 @@
+#pragma once
+#include <WiFi.h>
+class WiFiMulti { public: bool addAP(const char*, const char* = NULL) { return true; } uint8_t run(uint32_t = 5000); };
@@ -0,0 +1,8 @@
+#pragma once
+#include <stdint.h>
+// Bitwise reference of the ROM function : zlib CRC-32
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+  crc = ~crc;
+  while (len--) { crc ^= *buf++; for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1))); }
+  return ~crc;
+}
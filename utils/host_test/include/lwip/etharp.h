@@ -0,0 +1,6 @@
+#pragma once
+#include <lwip/netif.h>
+struct eth_addr { uint8_t addr[6]; };
+typedef int8_t err_t;
+err_t etharp_request(struct netif* netif, const ip4_addr_t* ipaddr);
+ssize_t etharp_find_addr(struct netif* netif, const ip4_addr_t* ipaddr, struct eth_addr** eth_ret, const ip4_addr_t** ip_ret);
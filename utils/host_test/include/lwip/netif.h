@@ -0,0 +1,9 @@
+#pragma once
+#include <stdint.h>
+#include <sys/types.h>
+typedef struct ip4_addr { uint32_t addr; } ip4_addr_t;
+#define ip4_addr_get_u32(a) ((a)->addr)
+#define ip4_addr_set_u32(a, v) ((a)->addr = (v))
+struct netif { struct netif* next; ip4_addr_t ip_addr; uint8_t hwaddr[6]; };
+#define netif_ip4_addr(n) (&(n)->ip_addr)
+extern struct netif* netif_list;
@@ -0,0 +1,4 @@
+#pragma once
+#include <lwip/etharp.h>
+typedef void (*tcpip_callback_fn)(void* ctx);
+err_t tcpip_callback(tcpip_callback_fn function, void* ctx);
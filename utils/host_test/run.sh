@@ -0,0 +1,38 @@
+#!/bin/bash
+#
+# Host tests of the library, against the mocked Arduino / ESP cores in ./include. No board needed, only g++.
+# Usage : utils/host_test/run.sh
+
+cd "$(dirname "$0")"
+
+CXX="g++ -std=gnu++17 -O1 -Wall -Wextra -Wno-cpp -Iinclude -I../../src -D_ESP_WM_LITE_LOGLEVEL_=0"
+ESP32="-DESP32=1 -DESP_ARDUINO_VERSION_MAJOR=2"
+ESP8266="-DESP8266=1"
+OUT=$(mktemp -d)
+failed=0
+
+trap 'rm -rf "$OUT"' EXIT
+
+# run <test> <flags...>
+run()
+{
+  name=$1
+  shift
+
+  echo "== $name $*"
+
+  if ! $CXX "$@" -c stubs.cpp -o "$OUT/stubs.o" || ! $CXX "$@" "$name.cpp" "$OUT/stubs.o" -o "$OUT/$name"; then
+    echo "BUILD FAILED"
+    failed=1
+  elif ! "$OUT/$name"; then
+    failed=1
+  fi
+}
+
+for platform in "$ESP32" "$ESP8266"; do
+  run connect_test $platform -DUSE_LITTLEFS=true -DUSING_NONBLOCKING_CONNECT=true
+  run connect_test $platform -DUSE_LITTLEFS=true -DUSING_NONBLOCKING_CONNECT=true -DUSING_WIFI_EVENTS=true
+  run eeprom_test $platform
+done
+
+exit $failed
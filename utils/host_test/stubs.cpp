@@ -0,0 +1,36 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <EEPROM.h>
+#include <LittleFS.h>
+#include <SPIFFS.h>
+unsigned long mockMillis = 0;
+unsigned long millis() { return mockMillis; }
+unsigned long micros() { return 0; }
+void delay(unsigned long ms) { mockMillis += ms; }
+void yield() {}
+void pinMode(int, int) {}
+void digitalWrite(int, int) {}
+long random(long) { return 0; }
+long random(long, long) { return 0; }
+void randomSeed(unsigned long) {}
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+EEPROMClass EEPROM;
+FS LittleFS;
+FS SPIFFS;
+int unused_main() { return 0; }
+#include <WiFiMulti.h>
+unsigned long multiRunBlockMs = 0; bool multiRunFails = false;
+uint8_t WiFiMulti::run(uint32_t) { mockMillis += multiRunBlockMs; if (multiRunFails) return WL_DISCONNECTED; WiFi.connectAt = 0; WiFi.staStatus = WL_CONNECTED; return WL_CONNECTED; }
+#include <lwip/tcpip.h>
+struct netif mockNetif = { nullptr, { 0 }, { 0x24, 0x0A, 0xC4, 0, 0, 1 } };
+struct netif* netif_list = &mockNetif;
+// ARP cache : one entry, for any IP, if arpAnswer
+int arpRequests = 0; uint32_t arpRequestIP = 0; bool arpAnswer = false; struct eth_addr arpAnswerMAC = { { 0 } };
+err_t etharp_request(struct netif*, const ip4_addr_t* ip) { arpRequests++; arpRequestIP = ip->addr; return 0; }
+ssize_t etharp_find_addr(struct netif*, const ip4_addr_t*, struct eth_addr** eth, const ip4_addr_t**) { if (!arpAnswer) return -1; *eth = &arpAnswerMAC; return 0; }
+err_t tcpip_callback(tcpip_callback_fn f, void* ctx) { f(ctx); return 0; }
+#include <esp_wifi.h>
+int scanStops = 0;
+esp_err_t esp_wifi_scan_stop() { scanStops++; WiFi.scanState = WIFI_SCAN_FAILED; return 0; }